@@ -0,0 +1,295 @@
+#include "Archetype.hpp"
+#include "Entity.hpp"
+#include "Query.hpp"
+#include <algorithm>
+
+namespace wpwp
+{
+    Archetype::Archetype(const ComponentMask &mask) : m_mask(mask)
+    {
+        m_columnOf.fill(-1);
+        m_mask.forEach([&](ComponentTypeId type)
+                       {
+            m_columnOf[type] = static_cast<std::int16_t>(m_types.size());
+            m_types.push_back(type); });
+
+        m_columns.resize(m_types.size());
+    }
+
+    void Archetype::reserve(std::size_t extraRows)
+    {
+        m_entities.reserve(m_entities.size() + extraRows);
+        for (auto &column : m_columns)
+        {
+            column.reserve(column.size() + extraRows);
+        }
+    }
+
+    std::size_t Archetype::pushRow(Entity *entity)
+    {
+        m_entities.push_back(entity);
+        for (auto &column : m_columns)
+        {
+            column.emplace_back();
+        }
+        return m_entities.size() - 1;
+    }
+
+    Entity *Archetype::swapRemoveRow(std::size_t row)
+    {
+        std::size_t last = m_entities.size() - 1;
+        Entity *moved = nullptr;
+
+        if (row != last)
+        {
+            m_entities[row] = m_entities[last];
+            for (auto &column : m_columns)
+            {
+                column[row] = std::move(column[last]);
+            }
+            moved = m_entities[row];
+        }
+
+        m_entities.pop_back();
+        for (auto &column : m_columns)
+        {
+            column.pop_back();
+        }
+        return moved;
+    }
+
+    ArchetypeStorage &ArchetypeStorage::getInstance()
+    {
+        static ArchetypeStorage instance;
+        return instance;
+    }
+
+    ArchetypeStorage::~ArchetypeStorage()
+    {
+        // Entities may outlive the storage during static destruction, make sure they don't point into it
+        for (auto &archetype : m_archetypes)
+        {
+            for (Entity *entity : archetype->m_entities)
+            {
+                entity->m_archetype = nullptr;
+            }
+        }
+    }
+
+    bool ArchetypeStorage::addComponent(Entity &entity, ComponentTypeId type, std::shared_ptr<Component> component)
+    {
+        Archetype *source = entity.m_archetype;
+        Archetype *destination = nullptr;
+
+        if (source)
+        {
+            if (source->has(type))
+            {
+                return false;
+            }
+
+            auto edge = source->m_addEdges.find(type);
+            if (edge != source->m_addEdges.end())
+            {
+                destination = edge->second;
+            }
+            else
+            {
+                ComponentMask mask = source->m_mask;
+                mask.set(type);
+
+                destination = getOrCreateArchetype(mask);
+                source->m_addEdges[type] = destination;
+                destination->m_removeEdges[type] = source;
+            }
+        }
+        else
+        {
+            ComponentMask mask;
+            mask.set(type);
+            destination = getOrCreateArchetype(mask);
+        }
+
+        moveEntity(entity, *destination);
+        destination->m_columns[destination->getColumnIndex(type)][entity.m_row] = std::move(component);
+        return true;
+    }
+
+    std::shared_ptr<Component> ArchetypeStorage::removeComponent(Entity &entity, ComponentTypeId type)
+    {
+        Archetype *source = entity.m_archetype;
+        if (!source)
+        {
+            return nullptr;
+        }
+
+        int column = source->getColumnIndex(type);
+        if (column == -1)
+        {
+            return nullptr;
+        }
+
+        std::shared_ptr<Component> removed = std::move(source->m_columns[column][entity.m_row]);
+
+        if (source->m_types.size() == 1)
+        {
+            removeEntity(entity);
+            return removed;
+        }
+
+        Archetype *destination = nullptr;
+        auto edge = source->m_removeEdges.find(type);
+        if (edge != source->m_removeEdges.end())
+        {
+            destination = edge->second;
+        }
+        else
+        {
+            ComponentMask mask = source->m_mask;
+            mask.reset(type);
+
+            destination = getOrCreateArchetype(mask);
+            source->m_removeEdges[type] = destination;
+            destination->m_addEdges[type] = source;
+        }
+
+        moveEntity(entity, *destination);
+        return removed;
+    }
+
+    void ArchetypeStorage::removeEntity(Entity &entity)
+    {
+        Archetype *source = entity.m_archetype;
+        if (!source)
+        {
+            return;
+        }
+
+        // Keep the components alive until the row is gone, so their destructors never see a half-removed row
+        std::vector<std::shared_ptr<Component>> released;
+        released.reserve(source->m_columns.size());
+        for (auto &column : source->m_columns)
+        {
+            released.push_back(std::move(column[entity.m_row]));
+        }
+
+        if (Entity *moved = source->swapRemoveRow(entity.m_row))
+        {
+            moved->m_row = entity.m_row;
+        }
+
+        entity.m_archetype = nullptr;
+        entity.m_row = 0;
+        entity.m_componentMask = ComponentMask();
+    }
+
+    void ArchetypeStorage::applyChanges(Entity &entity, const ComponentMask &removed, ComponentList &added)
+    {
+        Archetype *source = entity.m_archetype;
+        ComponentMask mask = source ? source->m_mask : ComponentMask();
+
+        // Keep the removed components alive until the entity left its row, like removeEntity does
+        std::vector<std::shared_ptr<Component>> released;
+        if (source)
+        {
+            (removed & mask).forEach([&](ComponentTypeId type)
+                                     {
+                released.push_back(std::move(source->m_columns[source->getColumnIndex(type)][entity.m_row]));
+                mask.reset(type); });
+        }
+
+        for (auto &entry : added)
+        {
+            mask.set(entry.first);
+        }
+
+        if (!mask.any())
+        {
+            removeEntity(entity);
+            return;
+        }
+
+        Archetype *destination = getOrCreateArchetype(mask);
+        if (destination != source)
+        {
+            moveEntity(entity, *destination);
+        }
+
+        for (auto &[type, component] : added)
+        {
+            destination->m_columns[destination->getColumnIndex(type)][entity.m_row] = std::move(component);
+        }
+    }
+
+    void ArchetypeStorage::reserve(const ComponentMask &mask, std::size_t count)
+    {
+        if (mask.any())
+        {
+            getOrCreateArchetype(mask)->reserve(count);
+        }
+    }
+
+    Archetype *ArchetypeStorage::getOrCreateArchetype(const ComponentMask &mask)
+    {
+        auto it = m_lookup.find(mask);
+        if (it != m_lookup.end())
+        {
+            return it->second;
+        }
+
+        m_archetypes.push_back(std::make_unique<Archetype>(mask));
+        Archetype *archetype = m_archetypes.back().get();
+        m_lookup[mask] = archetype;
+
+        mask.forEach([&](ComponentTypeId type)
+                     { m_archetypesWith[type].push_back(m_archetypes.size() - 1); });
+
+        for (QueryBase *query : m_queries)
+        {
+            query->tryMatch(*archetype);
+        }
+        return archetype;
+    }
+
+    void ArchetypeStorage::registerQuery(QueryBase &query)
+    {
+        for (auto &archetype : m_archetypes)
+        {
+            query.tryMatch(*archetype);
+        }
+        m_queries.push_back(&query);
+    }
+
+    void ArchetypeStorage::unregisterQuery(QueryBase &query)
+    {
+        m_queries.erase(std::remove(m_queries.begin(), m_queries.end(), &query), m_queries.end());
+    }
+
+    void ArchetypeStorage::moveEntity(Entity &entity, Archetype &destination)
+    {
+        Archetype *source = entity.m_archetype;
+        std::size_t newRow = destination.pushRow(&entity);
+
+        if (source)
+        {
+            std::size_t oldRow = entity.m_row;
+            for (std::size_t i = 0; i < source->m_columns.size(); i++)
+            {
+                int column = destination.getColumnIndex(source->m_types[i]);
+                if (column != -1)
+                {
+                    destination.m_columns[column][newRow] = std::move(source->m_columns[i][oldRow]);
+                }
+            }
+
+            if (Entity *moved = source->swapRemoveRow(oldRow))
+            {
+                moved->m_row = oldRow;
+            }
+        }
+
+        entity.m_archetype = &destination;
+        entity.m_row = newRow;
+        entity.m_componentMask = destination.m_mask;
+    }
+} // namespace wpwp
@@ -0,0 +1,308 @@
+#ifndef ARCHETYPE_HPP
+#define ARCHETYPE_HPP
+
+#include <vector>
+#include <array>
+#include <iterator>
+#include <memory>
+#include <unordered_map>
+#include "ComponentType.hpp"
+
+namespace wpwp
+{
+    class Entity;
+    struct Component;
+    class QueryBase;
+
+    /**
+     * @brief Components to add to an entity, paired with their type ids.
+     */
+    using ComponentList = std::vector<std::pair<ComponentTypeId, std::shared_ptr<Component>>>;
+
+    /**
+     * @brief Storage block shared by every entity that has the exact same set of component types.
+     *
+     * Each component type gets its own column, row `i` of every column belongs to the entity at row `i`.
+     * Columns are arrays of owning pointers, not of the components themselves: components are polymorphic, handed out as
+     * shared_ptr and kept by address in gameplay code, so they can't move when their entity changes archetype.
+     * Components of one type are still packed together, by the per-type slab pools of the scene's Arena.
+     */
+    class Archetype
+    {
+    public:
+        /**
+         * @brief Constructs an empty archetype for the given set of types.
+         *
+         * @param mask The component types stored in this archetype.
+         */
+        explicit Archetype(const ComponentMask &mask);
+
+        /**
+         * @brief Gets the component types stored in this archetype.
+         *
+         * @return The type mask of the archetype.
+         */
+        const ComponentMask &getMask() const { return m_mask; }
+
+        /**
+         * @brief Gets the type id of every column, in column order.
+         *
+         * @return The type ids of the archetype, sorted ascending.
+         */
+        const std::vector<ComponentTypeId> &getTypes() const { return m_types; }
+
+        /**
+         * @brief Gets the amount of entities (rows) stored in this archetype.
+         *
+         * @return The row count.
+         */
+        std::size_t size() const { return m_entities.size(); }
+
+        /**
+         * @brief Gets the amount of component columns in this archetype.
+         *
+         * @return The column count.
+         */
+        std::size_t getColumnCount() const { return m_columns.size(); }
+
+        /**
+         * @brief Gets the column index of a component type.
+         *
+         * @param type The component type to look for.
+         * @return The column index, or -1 if the type is not part of the archetype.
+         */
+        int getColumnIndex(ComponentTypeId type) const { return m_columnOf[type]; }
+
+        /**
+         * @brief Checks if the archetype stores the given component type.
+         *
+         * @param type The component type to look for.
+         * @return True if the type is part of the archetype.
+         */
+        bool has(ComponentTypeId type) const { return m_mask.test(type); }
+
+        /**
+         * @brief Gets the component of a type at a row, the type must be part of the archetype.
+         *
+         * @param type The component type.
+         * @param row The row of the entity.
+         * @return Pointer to the component.
+         */
+        Component *getComponent(ComponentTypeId type, std::size_t row) const { return m_columns[m_columnOf[type]][row].get(); }
+
+        /**
+         * @brief Gets a component column.
+         *
+         * @param index The column index.
+         * @return The pointers to the components of that column, by row.
+         */
+        std::vector<std::shared_ptr<Component>> &getColumn(std::size_t index) { return m_columns[index]; }
+        const std::vector<std::shared_ptr<Component>> &getColumn(std::size_t index) const { return m_columns[index]; }
+
+        /**
+         * @brief Gets the entities stored in the archetype, indexed by row.
+         *
+         * @return The entity of every row.
+         */
+        const std::vector<Entity *> &getEntities() const { return m_entities; }
+
+    private:
+        /**
+         * @brief Reserves room for more rows in every column.
+         */
+        void reserve(std::size_t extraRows);
+
+        /**
+         * @brief Appends an empty row for the entity.
+         *
+         * @return The index of the new row.
+         */
+        std::size_t pushRow(Entity *entity);
+
+        /**
+         * @brief Removes a row by moving the last row into its place.
+         *
+         * @return The entity that was moved into the row, or nullptr if the removed row was the last one.
+         */
+        Entity *swapRemoveRow(std::size_t row);
+
+    private:
+        ComponentMask m_mask;                                           // Component types of the archetype.
+        std::vector<ComponentTypeId> m_types;                           // Type id of each column, sorted ascending.
+        std::array<std::int16_t, MAX_COMPONENT_TYPES> m_columnOf;       // Column of each type id, -1 if absent.
+        std::vector<Entity *> m_entities;                               // Entity of each row.
+        std::vector<std::vector<std::shared_ptr<Component>>> m_columns; // One column of owning pointers per component type.
+
+        std::unordered_map<ComponentTypeId, Archetype *> m_addEdges;    // Cached archetype reached by adding a type.
+        std::unordered_map<ComponentTypeId, Archetype *> m_removeEdges; // Cached archetype reached by removing a type.
+
+        friend class ArchetypeStorage;
+    };
+
+    /**
+     * @brief View over the components of one entity, reading straight from its archetype row.
+     * Nothing is copied and no reference counts are touched, it's invalidated when the entity gains or loses a component.
+     */
+    class ComponentRange
+    {
+    public:
+        class Iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = Component;
+            using difference_type = std::ptrdiff_t;
+            using pointer = Component *;
+            using reference = Component &;
+
+            Iterator() = default;
+            Iterator(const Archetype *archetype, std::size_t row, std::size_t column) : m_archetype(archetype), m_row(row), m_column(column) {}
+
+            Component &operator*() const { return *m_archetype->getColumn(m_column)[m_row]; }
+            Component *operator->() const { return m_archetype->getColumn(m_column)[m_row].get(); }
+
+            Iterator &operator++()
+            {
+                m_column++;
+                return *this;
+            }
+
+            Iterator operator++(int)
+            {
+                Iterator previous = *this;
+                m_column++;
+                return previous;
+            }
+
+            bool operator==(const Iterator &other) const { return m_column == other.m_column; }
+
+        private:
+            const Archetype *m_archetype = nullptr;
+            std::size_t m_row = 0;
+            std::size_t m_column = 0;
+        };
+
+        ComponentRange() = default;
+        ComponentRange(const Archetype *archetype, std::size_t row) : m_archetype(archetype), m_row(row) {}
+
+        Iterator begin() const { return Iterator(m_archetype, m_row, 0); }
+        Iterator end() const { return Iterator(m_archetype, m_row, size()); }
+
+        std::size_t size() const { return m_archetype ? m_archetype->getColumnCount() : 0; }
+        bool empty() const { return size() == 0; }
+
+    private:
+        const Archetype *m_archetype = nullptr; // Archetype holding the entity, nullptr if it has no components.
+        std::size_t m_row = 0;                  // Row of the entity inside the archetype.
+    };
+
+    /**
+     * @brief Owns all the archetypes and moves entities between them as components are added or removed.
+     */
+    class ArchetypeStorage
+    {
+    public:
+        /**
+         * @brief Get the singleton instance of the storage.
+         *
+         * @return Reference to the storage.
+         */
+        static ArchetypeStorage &getInstance();
+
+        ~ArchetypeStorage();
+
+        /**
+         * @brief Adds a component to an entity, moving the entity into the matching archetype.
+         * Does nothing if the entity already has a component of the same type.
+         *
+         * @param entity The entity to add the component to.
+         * @param type The type id of the component.
+         * @param component The component to add.
+         * @return True if the component was added.
+         */
+        bool addComponent(Entity &entity, ComponentTypeId type, std::shared_ptr<Component> component);
+
+        /**
+         * @brief Removes the component of the given type from an entity.
+         *
+         * @param entity The entity to remove the component from.
+         * @param type The type id of the component to remove.
+         * @return The removed component, or nullptr if the entity didn't have one.
+         */
+        std::shared_ptr<Component> removeComponent(Entity &entity, ComponentTypeId type);
+
+        /**
+         * @brief Removes the entity and all of its components from the storage.
+         *
+         * @param entity The entity to remove.
+         */
+        void removeEntity(Entity &entity);
+
+        /**
+         * @brief Adds and removes several components at once, moving the entity to its final archetype only once.
+         *
+         * @param entity The entity to change.
+         * @param removed The types of the components to remove.
+         * @param added The components to add with their type ids, none of them may be on the entity already unless also removed.
+         */
+        void applyChanges(Entity &entity, const ComponentMask &removed, ComponentList &added);
+
+        /**
+         * @brief Reserves room for more entities in the archetype of a set of types, creating the archetype if needed.
+         *
+         * @param mask The component types of the archetype.
+         * @param count The amount of entities about to be added.
+         */
+        void reserve(const ComponentMask &mask, std::size_t count);
+
+        /**
+         * @brief Gets the amount of archetypes created so far.
+         *
+         * @return The archetype count.
+         */
+        std::size_t getArchetypeCount() const { return m_archetypes.size(); }
+
+        /**
+         * @brief Gets an archetype by index.
+         *
+         * @param index The archetype index.
+         * @return Reference to the archetype.
+         */
+        Archetype &getArchetype(std::size_t index) { return *m_archetypes[index]; }
+
+        /**
+         * @brief Gets the archetypes that have a column of the given type.
+         *
+         * @param type The component type id.
+         * @return Indices of the archetypes, in creation order.
+         */
+        const std::vector<std::size_t> &getArchetypesWith(ComponentTypeId type) const { return m_archetypesWith[type]; }
+
+    private:
+        ArchetypeStorage() = default;
+
+        Archetype *getOrCreateArchetype(const ComponentMask &mask);
+
+        /**
+         * @brief Starts notifying a query about new archetypes, matching it against the existing ones first.
+         */
+        void registerQuery(QueryBase &query);
+        void unregisterQuery(QueryBase &query);
+
+        /**
+         * @brief Moves an entity's row into another archetype, carrying over the components both archetypes share.
+         */
+        void moveEntity(Entity &entity, Archetype &destination);
+
+    private:
+        std::unordered_map<ComponentMask, Archetype *> m_lookup; // Type mask to archetype lookup.
+        std::vector<std::unique_ptr<Archetype>> m_archetypes;    // All the archetypes, in creation order.
+        std::vector<QueryBase *> m_queries;                      // Live queries, matched against every new archetype.
+
+        std::array<std::vector<std::size_t>, MAX_COMPONENT_TYPES> m_archetypesWith; // Indices of the archetypes having each type.
+
+        friend class QueryBase;
+    };
+} // namespace wpwp
+
+#endif // ARCHETYPE_HPP
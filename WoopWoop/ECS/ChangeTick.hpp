@@ -0,0 +1,39 @@
+#ifndef CHANGE_TICK_HPP
+#define CHANGE_TICK_HPP
+
+#include <atomic>
+#include <cstdint>
+
+namespace wpwp
+{
+    using Tick = std::uint64_t;
+
+    /**
+     * @brief Global version counter used to find component data that changed since an observer last looked at it.
+     *
+     * Changes are stamped with the current tick, an observer calls observe() once it processed every change and keeps the returned tick,
+     * anything stamped after that compares as newer.
+     */
+    class ChangeTicks
+    {
+    public:
+        /**
+         * @brief Gets the tick changes made right now are stamped with.
+         *
+         * @return The current tick.
+         */
+        static Tick current() { return s_tick.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Records that the caller has seen every change made so far.
+         *
+         * @return The tick to pass to Component::changedSince next time.
+         */
+        static Tick observe() { return s_tick.fetch_add(1, std::memory_order_relaxed); }
+
+    private:
+        static inline std::atomic<Tick> s_tick{1};
+    };
+} // namespace wpwp
+
+#endif // CHANGE_TICK_HPP
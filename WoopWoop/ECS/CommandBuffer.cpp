@@ -0,0 +1,192 @@
+#include "CommandBuffer.hpp"
+#include "Entity.hpp"
+#include <algorithm>
+#include <unordered_set>
+
+namespace wpwp
+{
+    CommandBuffer::PendingEntity CommandBuffer::createEntity(std::string name, sf::Vector3f initialPos)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_creations.push_back(Creation{std::move(name), initialPos, nullptr});
+        return PendingEntity{static_cast<std::uint32_t>(m_creations.size() - 1)};
+    }
+
+    CommandBuffer::PendingEntity CommandBuffer::instantiate(std::shared_ptr<Entity> entity)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_creations.push_back(Creation{{}, {}, std::move(entity)});
+        return PendingEntity{static_cast<std::uint32_t>(m_creations.size() - 1)};
+    }
+
+    void CommandBuffer::destroy(Target target)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_commands.push_back(Command{Command::Type::Destroy, target, 0, nullptr});
+    }
+
+    void CommandBuffer::addComponent(Target target, std::shared_ptr<Component> component)
+    {
+        if (!component)
+            return;
+
+        // Resolved before the call, the argument moving the pointer may be evaluated first
+        ComponentTypeId type = ComponentTypes::getOrAssign(typeid(*component));
+        addComponent(target, type, std::move(component));
+    }
+
+    void CommandBuffer::addComponent(Target target, ComponentTypeId type, std::shared_ptr<Component> component)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_commands.push_back(Command{Command::Type::AddComponent, target, type, std::move(component)});
+    }
+
+    void CommandBuffer::removeComponent(Target target, ComponentTypeId type)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_commands.push_back(Command{Command::Type::RemoveComponent, target, type, nullptr});
+    }
+
+    bool CommandBuffer::isEmpty()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_creations.empty() && m_commands.empty();
+    }
+
+    void CommandBuffer::clear()
+    {
+        std::vector<Creation> creations;
+        std::vector<Command> commands;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::swap(m_creations, creations);
+            std::swap(m_commands, commands);
+        }
+        // The entities and components they held are freed here, outside the lock, in case their destructors record more
+    }
+
+    void CommandBuffer::apply()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_creations.empty() && m_commands.empty())
+            {
+                return;
+            }
+
+            std::swap(m_creations, m_applyingCreations);
+            std::swap(m_commands, m_applyingCommands);
+        }
+
+        // Construct the new entities first, so commands targeting them can resolve to real ids
+        for (Creation &creation : m_applyingCreations)
+        {
+            if (!creation.entity)
+            {
+                creation.entity = Entity::createEntity(creation.name, creation.position);
+            }
+        }
+
+        for (Command &command : m_applyingCommands)
+        {
+            if (command.target.pending != EntityId::INVALID_INDEX)
+            {
+                command.target.id = m_applyingCreations[command.target.pending].entity->getId();
+            }
+        }
+
+        // Sorted by entity, recording order is kept within an entity. The generation is part of the key,
+        // so a stale id never shares a group with the entity that reused its slot
+        std::stable_sort(m_applyingCommands.begin(), m_applyingCommands.end(), [](const Command &a, const Command &b)
+                         { return a.target.id.toU64() < b.target.id.toU64(); });
+
+        std::unordered_set<Entity *> destroyed;
+        std::vector<Entity *> destroyOrder; // Destroyed in id order, not in the set's
+        for (auto begin = m_applyingCommands.begin(); begin != m_applyingCommands.end();)
+        {
+            auto end = std::find_if(begin, m_applyingCommands.end(), [&](const Command &command)
+                                    { return !(command.target.id == begin->target.id); });
+
+            // Commands for a stale id (e.g. an entity destroyed directly since) are dropped
+            Entity *entity = Entity::get(begin->target.id);
+            if (entity)
+            {
+                bool isDestroyed = std::any_of(begin, end, [](const Command &command)
+                                               { return command.type == Command::Type::Destroy; });
+                if (isDestroyed)
+                {
+                    destroyed.insert(entity);
+                    destroyOrder.push_back(entity);
+                }
+                else
+                {
+                    applyComponentChanges(*entity, begin, end);
+                }
+            }
+            begin = end;
+        }
+
+        for (Creation &creation : m_applyingCreations)
+        {
+            // Created and destroyed in the same batch, dropping the last reference is enough
+            if (!destroyed.erase(creation.entity.get()) && !creation.entity->isInstantiated())
+            {
+                Entity::instantiate(creation.entity);
+            }
+        }
+
+        // Each removal is constant time, the entity's slot in s_entities is swapped with the last one
+        for (Entity *entity : destroyOrder)
+        {
+            if (destroyed.count(entity) && entity->isInstantiated())
+            {
+                Entity::destroy(Entity::s_entities[entity->m_instanceIndex]);
+            }
+        }
+
+        m_applyingCreations.clear();
+        m_applyingCommands.clear();
+    }
+
+    void CommandBuffer::applyComponentChanges(Entity &entity, std::vector<Command>::iterator begin, std::vector<Command>::iterator end)
+    {
+        ComponentMask mask = entity.getComponentMask();
+        ComponentMask removed;
+        ComponentList added;
+
+        // Folded in recording order, adding a type the entity already has is ignored like Entity::addComponent does
+        for (auto it = begin; it != end; it++)
+        {
+            if (it->type == Command::Type::AddComponent)
+            {
+                if (!mask.test(it->component))
+                {
+                    mask.set(it->component);
+                    added.emplace_back(it->component, std::move(it->added));
+                }
+            }
+            else if (it->type == Command::Type::RemoveComponent && mask.test(it->component) && Entity::isRemovable(it->component))
+            {
+                mask.reset(it->component);
+
+                auto pending = std::find_if(added.begin(), added.end(), [&](const auto &entry)
+                                            { return entry.first == it->component; });
+                if (pending != added.end())
+                {
+                    added.erase(pending);
+                }
+                else
+                {
+                    removed.set(it->component);
+                }
+            }
+        }
+
+        if (added.empty() && !removed.any())
+        {
+            return;
+        }
+
+        entity.applyChanges(removed, added);
+    }
+} // namespace wpwp
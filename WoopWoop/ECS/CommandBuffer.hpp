@@ -0,0 +1,182 @@
+#ifndef COMMAND_BUFFER_HPP
+#define COMMAND_BUFFER_HPP
+
+#include <SFML/System/Vector3.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ComponentType.hpp"
+#include "EntityId.hpp"
+#include "Util/Arena.hpp"
+
+namespace wpwp
+{
+    class Entity;
+    struct Component;
+
+    /**
+     * @brief Records structural changes (creating, destroying, adding and removing components) to apply them later at a sync point.
+     *
+     * Recording is thread safe, so systems running on the thread pool can queue changes while the world is being iterated.
+     * apply() must be called from the main thread, it groups the commands by entity so every entity moves between archetypes at most once.
+     */
+    class CommandBuffer
+    {
+    public:
+        /**
+         * @brief Handle to an entity created through the buffer, usable as a target before the entity exists.
+         */
+        struct PendingEntity
+        {
+            std::uint32_t index; // Index of the creation in the buffer.
+        };
+
+        /**
+         * @brief Entity a command applies to, either an existing entity or one created by the same buffer.
+         */
+        struct Target
+        {
+            Target(EntityId id) : id(id) {}
+            Target(PendingEntity entity) : pending(entity.index) {}
+
+            EntityId id;                                     // Id of an existing entity.
+            std::uint32_t pending = EntityId::INVALID_INDEX; // Index of the creation, if the entity doesn't exist yet.
+        };
+
+        /**
+         * @brief Records creating and instantiating a new entity.
+         *
+         * @param name The name of the entity.
+         * @param initialPos The initial position of the entity.
+         * @return A handle commands recorded later in the same buffer can target.
+         */
+        PendingEntity createEntity(std::string name, sf::Vector3f initialPos);
+
+        /**
+         * @brief Records instantiating an entity that was already created.
+         *
+         * @param entity The entity to instantiate.
+         * @return A handle commands recorded later in the same buffer can target.
+         */
+        PendingEntity instantiate(std::shared_ptr<Entity> entity);
+
+        /**
+         * @brief Records destroying an entity.
+         *
+         * @param target The entity to destroy.
+         */
+        void destroy(Target target);
+
+        /**
+         * @brief Records adding a new component of type T, the component is constructed right away and attached on apply.
+         *
+         * @tparam T The type of component to add.
+         * @tparam Args Types of arguments to forward to the T's constructor.
+         * @param target The entity to add the component to.
+         * @param args Arguments to forward to the T's constructor.
+         */
+        template <typename T, typename... Args>
+        void addComponent(Target target, Args &&...args)
+        {
+            static_assert(std::is_base_of<Component, T>::value, "T must inherit from Component");
+            addComponent(target, ComponentTypes::get<T>(), Arena::makeShared<T>(std::forward<Args>(args)...));
+        }
+
+        /**
+         * @brief Records adding an existing component.
+         *
+         * @param target The entity to add the component to.
+         * @param component The component to add.
+         */
+        void addComponent(Target target, std::shared_ptr<Component> component);
+
+        /**
+         * @brief Records removing the component of type T, the type is matched exactly.
+         *
+         * @tparam T The type of component to remove.
+         * @param target The entity to remove the component from.
+         */
+        template <typename T>
+        void removeComponent(Target target)
+        {
+            static_assert(std::is_base_of<Component, T>::value, "T must inherit from Component");
+            removeComponent(target, ComponentTypes::get<T>());
+        }
+
+        /**
+         * @brief Records removing the component with the given type id.
+         *
+         * @param target The entity to remove the component from.
+         * @param type The type id of the component to remove.
+         */
+        void removeComponent(Target target, ComponentTypeId type);
+
+        /**
+         * @brief Applies every recorded command and clears the buffer, must be called from the main thread.
+         * Commands recorded while applying (e.g. from a component's start()) are kept for the next apply.
+         */
+        void apply();
+
+        /**
+         * @brief Drops every recorded command without applying it, e.g. when the scene they were recorded for is unloaded.
+         */
+        void clear();
+
+        /**
+         * @brief Checks if there are no recorded commands.
+         *
+         * @return True if the buffer is empty.
+         */
+        bool isEmpty();
+
+    private:
+        /**
+         * @brief A recorded entity creation or instantiation.
+         */
+        struct Creation
+        {
+            std::string name;               // Name of the entity to create.
+            sf::Vector3f position;          // Initial position of the entity to create.
+            std::shared_ptr<Entity> entity; // The entity, set upfront for instantiations and on apply for creations.
+        };
+
+        /**
+         * @brief A recorded change to an entity.
+         */
+        struct Command
+        {
+            enum class Type
+            {
+                Destroy,
+                AddComponent,
+                RemoveComponent
+            };
+
+            Type type;                        // What the command does.
+            Target target;                    // The entity the command applies to.
+            ComponentTypeId component = 0;    // Type of the added or removed component.
+            std::shared_ptr<Component> added; // The component to add.
+        };
+
+        void addComponent(Target target, ComponentTypeId type, std::shared_ptr<Component> component);
+
+        /**
+         * @brief Applies the component changes of one entity with a single archetype move.
+         *
+         * @param entity The entity to change.
+         * @param begin First command of the entity.
+         * @param end One past the last command of the entity.
+         */
+        void applyComponentChanges(Entity &entity, std::vector<Command>::iterator begin, std::vector<Command>::iterator end);
+
+    private:
+        std::mutex m_mutex;                        // Guards the recorded commands.
+        std::vector<Creation> m_creations;         // Recorded creations, in recording order.
+        std::vector<Command> m_commands;           // Recorded changes, in recording order.
+        std::vector<Creation> m_applyingCreations; // Creations being applied, kept around for its capacity.
+        std::vector<Command> m_applyingCommands;   // Changes being applied, kept around for its capacity.
+    };
+} // namespace wpwp
+
+#endif // COMMAND_BUFFER_HPP
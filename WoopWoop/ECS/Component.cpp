@@ -1,11 +1,14 @@
 #include "Component.hpp"
 #include "Entity.hpp"
+#include "Components/Transform.hpp"
+#include "Reflection.hpp"
 namespace wpwp
 {
-    void Component::attach(std::shared_ptr<Entity> e)
+    void Component::attach(Entity &e, ComponentTypeId type)
     {
-        entity = e;
-        transform = entity->transform;
+        entity = e.getId();
+        m_typeId = type;
+        transform = e.transform;
     }
 
     void Component::start()
@@ -16,7 +19,31 @@ namespace wpwp
     {
     }
 
+    void Component::fixedUpdate()
+    {
+    }
+
     void Component::onDisable()
     {
     }
+
+    void Component::onEnable()
+    {
+    }
+
+    void Component::onDrawGUI()
+    {
+        Reflection::drawFields(*this);
+    }
+
+    bool Component::pollTransformChanged()
+    {
+        if (!transform || !transform->changedSince(m_transformTick))
+        {
+            return false;
+        }
+
+        m_transformTick = ChangeTicks::observe();
+        return true;
+    }
 }
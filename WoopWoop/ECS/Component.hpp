@@ -3,8 +3,12 @@
 
 #include <SFML/Graphics.hpp>
 #include "BaseComponent.hpp"
+#include "ChangeTick.hpp"
+#include "ComponentType.hpp"
+#include "EntityId.hpp"
 #include "Registry.hpp"
 #include "Subsystems/Logging.hpp"
+#include "Util/Arena.hpp"
 #include <memory>
 #include <map>
 #include <string>
@@ -13,21 +17,27 @@
 public:             \
     virtual void onDrawGUI() override {};
 
-#define WREGISTER(type)                                                     \
-    namespace type##_registration_detail                                    \
-    {                                                                       \
-        struct Factory                                                      \
-        {                                                                   \
-            Factory()                                                       \
-            {                                                               \
-                wpwp::Registry::getInstance().registerType(#type, &create); \
-            }                                                               \
-            static std::shared_ptr<wpwp::Component> create()                \
-            {                                                               \
-                return std::make_shared<type>();                            \
-            }                                                               \
-        };                                                                  \
-        static Factory global_##type##Factory;                              \
+/**
+ * @brief Registers a component type, optionally with its reflected fields (see WFIELD and WPROPERTY),
+ * which drive the scene serializer and the default inspector.
+ */
+#define WREGISTER(type, ...)                                                                     \
+    namespace type##_registration_detail                                                         \
+    {                                                                                            \
+        struct Factory                                                                           \
+        {                                                                                        \
+            using Self = type;                                                                   \
+                                                                                                 \
+            Factory()                                                                            \
+            {                                                                                    \
+                wpwp::Registry::getInstance().registerType<type>(#type, &create, {__VA_ARGS__}); \
+            }                                                                                    \
+            static std::shared_ptr<wpwp::Component> create()                                     \
+            {                                                                                    \
+                return wpwp::Arena::makeShared<type>();                                          \
+            }                                                                                    \
+        };                                                                                       \
+        static Factory global_##type##Factory;                                                   \
     }
 
 namespace wpwp
@@ -41,17 +51,18 @@ namespace wpwp
     struct Component : BaseComponent
     {
     public:
-        std::shared_ptr<Entity> entity;       // Pointer to the entity the component is attached to.
-        std::shared_ptr<Transform> transform; // Pointer to the transform of the entity it's attached to.
-        bool m_enabled;                       // Flag indicating whether the component is enabled.
+        EntityHandle entity;            // Handle to the entity the component is attached to.
+        Transform *transform = nullptr; // Pointer to the transform of the entity it's attached to.
+        bool m_enabled;                 // Flag indicating whether the component is enabled.
 
     public:
         /**
          * @brief Attaches the component to an entity.
          *
-         * @param e Pointer to the entity to attach to.
+         * @param e The entity to attach to.
+         * @param type The type id of the column holding the component.
          */
-        void attach(std::shared_ptr<Entity> e);
+        void attach(Entity &e, ComponentTypeId type);
 
     public:
         Component(){};
@@ -66,23 +77,82 @@ namespace wpwp
          */
         virtual void update();
 
+        /**
+         * @brief Called once per simulation step, at the engine's tick rate, before update().
+         * Frame rate independent logic (physics, movement) goes here, Util::deltaTime() is the fixed step meanwhile.
+         */
+        virtual void fixedUpdate();
+
         /**
          * @brief Called when the component is disabled.
+         * Recycled entities call it on every component when they're destroyed.
          */
         virtual void onDisable();
 
+        /**
+         * @brief Called when a disabled component is enabled again.
+         * Recycled entities call it on every component when they're spawned again, after the prefab's values were applied.
+         */
+        virtual void onEnable();
+
         /**
          * @brief Virtual destructor.
          */
         virtual ~Component(){};
 
-        NO_DRAW_GUI
+        /**
+         * @brief Draws the component in the inspector, the reflected fields by default.
+         */
+        void onDrawGUI() override;
+
         /**
          * @brief Gets the name of the component.
          *
          * @return The name of the component.
          */
         virtual std::string getName() const { return "component"; }
+
+        /**
+         * @brief Stamps the component's data as changed at the current tick.
+         */
+        void markChanged() { m_changedTick = ChangeTicks::current(); }
+
+        /**
+         * @brief Checks if the component's data changed after the given tick.
+         *
+         * @param tick A tick returned by ChangeTicks::observe().
+         * @return True if the component was marked changed after that tick.
+         */
+        bool changedSince(Tick tick) const { return m_changedTick > tick; }
+
+        /**
+         * @brief Gets the tick the component was last marked changed at.
+         *
+         * @return The tick of the last change, 0 if it never changed.
+         */
+        Tick getChangedTick() const { return m_changedTick; }
+
+        /**
+         * @brief Gets the type id the component is stored under, known without RTTI once attached.
+         *
+         * @return The type id, MAX_COMPONENT_TYPES if the component was never attached.
+         */
+        ComponentTypeId getTypeId() const { return m_typeId; }
+
+    protected:
+        /**
+         * @brief Checks if the entity's transform changed since the last call, for components that mirror the transform once per frame.
+         *
+         * @return True if the transform changed since this component last saw it.
+         */
+        bool pollTransformChanged();
+
+    protected:
+        Tick m_transformTick = 0; // Tick this component last saw the transform at.
+
+    private:
+        Tick m_changedTick = 0;                         // Tick the component was last marked changed at.
+        ComponentTypeId m_typeId = MAX_COMPONENT_TYPES; // Type id of the column holding the component.
     };
 } // namespace wpwp
 
@@ -0,0 +1,75 @@
+#include "ComponentType.hpp"
+#include "Subsystems/Logging.hpp"
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+#include <cstdlib>
+#include <mutex>
+
+namespace wpwp
+{
+    namespace
+    {
+        struct TypeTable
+        {
+            std::unordered_map<std::type_index, ComponentTypeId> ids;
+            std::vector<std::type_index> types;
+            std::mutex mutex; // Ids may be assigned from worker threads, e.g. when recording commands.
+        };
+
+        // Function local so ids can be handed out during static initialization
+        TypeTable &getTable()
+        {
+            static TypeTable table;
+            return table;
+        }
+    }
+
+    ComponentTypeId ComponentTypes::getOrAssign(const std::type_info &type)
+    {
+        TypeTable &table = getTable();
+        std::lock_guard<std::mutex> lock(table.mutex);
+
+        auto it = table.ids.find(type);
+        if (it != table.ids.end())
+        {
+            return it->second;
+        }
+
+        if (table.types.size() >= MAX_COMPONENT_TYPES)
+        {
+            ERROR("Too many component types, raise MAX_COMPONENT_TYPES (", MAX_COMPONENT_TYPES, ")");
+            std::abort();
+        }
+
+        ComponentTypeId id = static_cast<ComponentTypeId>(table.types.size());
+        table.types.push_back(type);
+        table.ids.emplace(type, id);
+        return id;
+    }
+
+    std::size_t ComponentTypes::count()
+    {
+        TypeTable &table = getTable();
+        std::lock_guard<std::mutex> lock(table.mutex);
+        return table.types.size();
+    }
+
+    AtomicComponentMask &ComponentTypes::getNoUpdateMask()
+    {
+        static AtomicComponentMask mask;
+        return mask;
+    }
+
+    AtomicComponentMask &ComponentTypes::getNoFixedUpdateMask()
+    {
+        static AtomicComponentMask mask;
+        return mask;
+    }
+
+    ComponentTypes::Relations &ComponentTypes::getRelations(ComponentTypeId id)
+    {
+        static std::array<Relations, MAX_COMPONENT_TYPES> relations{};
+        return relations[id];
+    }
+} // namespace wpwp
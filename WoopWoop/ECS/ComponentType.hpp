@@ -0,0 +1,302 @@
+#ifndef COMPONENT_TYPE_HPP
+#define COMPONENT_TYPE_HPP
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <typeinfo>
+#include <type_traits>
+
+namespace wpwp
+{
+    struct Component;
+
+    /**
+     * @brief Dense index identifying a component type, assigned once per type.
+     */
+    using ComponentTypeId = std::uint32_t;
+
+    /**
+     * @brief Maximum amount of distinct component types.
+     */
+    constexpr std::size_t MAX_COMPONENT_TYPES = 256;
+
+    /**
+     * @brief Fixed size set of component type ids.
+     */
+    class ComponentMask
+    {
+    public:
+        void set(ComponentTypeId id) { m_words[id / 64] |= bit(id); }
+        void reset(ComponentTypeId id) { m_words[id / 64] &= ~bit(id); }
+        bool test(ComponentTypeId id) const { return (m_words[id / 64] & bit(id)) != 0; }
+
+        /**
+         * @brief Checks if any type is set.
+         */
+        bool any() const
+        {
+            for (auto word : m_words)
+            {
+                if (word)
+                    return true;
+            }
+            return false;
+        }
+
+        /**
+         * @brief Checks if every type of another mask is also set in this one.
+         */
+        bool contains(const ComponentMask &other) const { return (*this & other) == other; }
+
+        /**
+         * @brief Gets the lowest type id in the mask.
+         *
+         * @return The lowest set id, or -1 if the mask is empty.
+         */
+        int findFirst() const
+        {
+            for (std::size_t i = 0; i < WORD_COUNT; i++)
+            {
+                if (m_words[i])
+                    return static_cast<int>(i * 64 + std::countr_zero(m_words[i]));
+            }
+            return -1;
+        }
+
+        /**
+         * @brief Calls a function with every type id in the mask, in ascending order.
+         */
+        template <typename Func>
+        void forEach(Func func) const
+        {
+            for (std::size_t i = 0; i < WORD_COUNT; i++)
+            {
+                std::uint64_t word = m_words[i];
+                while (word)
+                {
+                    func(static_cast<ComponentTypeId>(i * 64 + std::countr_zero(word)));
+                    word &= word - 1;
+                }
+            }
+        }
+
+        std::size_t hash() const
+        {
+            std::size_t h = 0;
+            for (auto word : m_words)
+            {
+                h ^= std::hash<std::uint64_t>()(word) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+            }
+            return h;
+        }
+
+        ComponentMask operator&(const ComponentMask &other) const
+        {
+            ComponentMask result;
+            for (std::size_t i = 0; i < WORD_COUNT; i++)
+                result.m_words[i] = m_words[i] & other.m_words[i];
+            return result;
+        }
+
+        ComponentMask operator|(const ComponentMask &other) const
+        {
+            ComponentMask result;
+            for (std::size_t i = 0; i < WORD_COUNT; i++)
+                result.m_words[i] = m_words[i] | other.m_words[i];
+            return result;
+        }
+
+        ComponentMask operator~() const
+        {
+            ComponentMask result;
+            for (std::size_t i = 0; i < WORD_COUNT; i++)
+                result.m_words[i] = ~m_words[i];
+            return result;
+        }
+
+        bool operator==(const ComponentMask &other) const = default;
+
+    private:
+        friend class AtomicComponentMask;
+
+        static constexpr std::size_t WORD_COUNT = MAX_COMPONENT_TYPES / 64;
+
+        static std::uint64_t bit(ComponentTypeId id) { return std::uint64_t(1) << (id % 64); }
+
+        std::array<std::uint64_t, WORD_COUNT> m_words{};
+    };
+
+    /**
+     * @brief Set of component type ids that grows only, safe to read and add to from several threads at once.
+     */
+    class AtomicComponentMask
+    {
+    public:
+        /**
+         * @brief Adds a type, every write made before is visible to a thread that then sees the type set.
+         */
+        void set(ComponentTypeId id) { m_words[id / 64].fetch_or(ComponentMask::bit(id), std::memory_order_release); }
+
+        bool test(ComponentTypeId id) const { return (m_words[id / 64].load(std::memory_order_acquire) & ComponentMask::bit(id)) != 0; }
+
+        /**
+         * @brief Reads the types set so far, types added meanwhile may or may not be included.
+         */
+        ComponentMask load() const
+        {
+            ComponentMask result;
+            for (std::size_t i = 0; i < ComponentMask::WORD_COUNT; i++)
+                result.m_words[i] = m_words[i].load(std::memory_order_acquire);
+            return result;
+        }
+
+    private:
+        std::array<std::atomic<std::uint64_t>, ComponentMask::WORD_COUNT> m_words{};
+    };
+
+    /**
+     * @brief Checks at compile time if T (or a base between it and Component) overrides Component::update().
+     * An inherited update() is found by name lookup on Component, so &T::update is then a pointer to a Component member.
+     */
+    template <typename T>
+    constexpr bool overridesUpdate = !std::is_same_v<decltype(&T::update), void (Component::*)()>;
+
+    /**
+     * @brief Checks at compile time if T (or a base between it and Component) overrides Component::fixedUpdate().
+     */
+    template <typename T>
+    constexpr bool overridesFixedUpdate = !std::is_same_v<decltype(&T::fixedUpdate), void (Component::*)()>;
+
+    /**
+     * @brief Hands out dense ids to component types and remembers which types derive from which.
+     */
+    class ComponentTypes
+    {
+    public:
+        /**
+         * @brief Gets the id of a component type, assigning one on first use.
+         *
+         * @tparam T The component type.
+         * @return The id of the type.
+         */
+        template <typename T>
+        static ComponentTypeId get()
+        {
+            static_assert(std::is_base_of<Component, T>::value, "T must inherit from Component");
+            static const ComponentTypeId id = assign<T>();
+            return id;
+        }
+
+        /**
+         * @brief Gets the id of a component type from its runtime type, assigning one on first use.
+         *
+         * @param type The type_info of the component type.
+         * @return The id of the type.
+         */
+        static ComponentTypeId getOrAssign(const std::type_info &type);
+
+        /**
+         * @brief Gets the amount of ids handed out so far.
+         */
+        static std::size_t count();
+
+        /**
+         * @brief Checks if components of a type need their update() called.
+         * Only known for types that went through get<T>() (every WREGISTER type does), the others are assumed to update.
+         *
+         * @param id The id of the type.
+         * @return False if the type keeps the empty Component::update().
+         */
+        static bool hasUpdate(ComponentTypeId id) { return !getNoUpdateMask().test(id); }
+
+        /**
+         * @brief Checks if components of a type need their fixedUpdate() called, known for the same types as hasUpdate().
+         *
+         * @param id The id of the type.
+         * @return False if the type keeps the empty Component::fixedUpdate().
+         */
+        static bool hasFixedUpdate(ComponentTypeId id) { return !getNoFixedUpdateMask().test(id); }
+
+        /**
+         * @brief Finds a stored component whose type is T or derives from T.
+         *
+         * Every (T, stored type) pair is classified once with a dynamic_cast and cached,
+         * after that the lookup is only a couple of mask operations.
+         * Safe from several threads at once, two threads may both classify a new pair and record the same result.
+         *
+         * @tparam T The requested (base) type.
+         * @param mask The types of the components that can be returned.
+         * @param lookup Callable returning the stored component for a type id.
+         * @return The matching component, or nullptr if none of the types derive from T.
+         */
+        template <typename T, typename Lookup>
+        static Component *findDerived(const ComponentMask &mask, Lookup lookup)
+        {
+            Relations &relations = getRelations(get<T>());
+
+            ComponentMask untested = mask & ~relations.tested.load();
+            untested.forEach([&](ComponentTypeId candidate)
+                             {
+                // Derived before tested, a thread seeing the pair tested also sees its result
+                if (dynamic_cast<T *>(lookup(candidate)))
+                {
+                    relations.derived.set(candidate);
+                }
+                relations.tested.set(candidate); });
+
+            int match = (mask & relations.derived.load()).findFirst();
+            return match == -1 ? nullptr : lookup(static_cast<ComponentTypeId>(match));
+        }
+
+    private:
+        template <typename T>
+        static ComponentTypeId assign()
+        {
+            ComponentTypeId id = getOrAssign(typeid(T));
+            if constexpr (!overridesUpdate<T>)
+            {
+                getNoUpdateMask().set(id);
+            }
+            if constexpr (!overridesFixedUpdate<T>)
+            {
+                getNoFixedUpdateMask().set(id);
+            }
+            return id;
+        }
+
+        /**
+         * @brief Types known to keep the empty Component::update().
+         */
+        static AtomicComponentMask &getNoUpdateMask();
+
+        /**
+         * @brief Types known to keep the empty Component::fixedUpdate().
+         */
+        static AtomicComponentMask &getNoFixedUpdateMask();
+
+        /**
+         * @brief Cached inheritance information of a type.
+         */
+        struct Relations
+        {
+            AtomicComponentMask tested;  // Types already checked against this type.
+            AtomicComponentMask derived; // Types known to derive from this type.
+        };
+
+        static Relations &getRelations(ComponentTypeId id);
+    };
+} // namespace wpwp
+
+/**
+ * @brief Lets masks key unordered containers.
+ */
+template <>
+struct std::hash<wpwp::ComponentMask>
+{
+    std::size_t operator()(const wpwp::ComponentMask &mask) const { return mask.hash(); }
+};
+
+#endif // COMPONENT_TYPE_HPP
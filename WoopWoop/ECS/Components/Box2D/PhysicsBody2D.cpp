@@ -13,6 +13,7 @@ namespace wpwp
     {
         m_world = world;
         body = m_world->CreateBody(&bodyDef);
+        body->GetUserData().pointer = reinterpret_cast<uintptr_t>(this); // Lets the world step hand the body back to us
 
         // Ensure the body has a fixture
         b2PolygonShape boxShape;
@@ -29,38 +30,64 @@ namespace wpwp
         fixtureDef.friction = 0.3f;
 
         body->CreateFixture(&fixtureDef);
+        applyFilter();
+    }
+
+    void PhysicsBody2D::pushTransform()
+    {
+        b2Vec2 position = {transform->getPosition()->x, transform->getPosition()->y};
+        body->SetTransform(position, transform->getRotation()->z * 3.14 / 180);
 
-        transform->onTransformChanged += [&]()
+        // Moving the body doesn't need a new fixture, only resizing it does
+        sf::Vector2f scale(transform->getScale()->x, transform->getScale()->y);
+        if (scale == m_fixtureScale || !body->GetFixtureList())
         {
-            b2Vec2 position = {transform->getPosition()->x, transform->getPosition()->y};
-            body->SetTransform(position, transform->getRotation()->z);
-            if (body->GetFixtureList())
-            {
-                b2Fixture *fixture = body->GetFixtureList(); // Get pointer to the fixture
-                b2FixtureDef def;
-                def.density = fixture->GetDensity();
-                def.restitution = fixture->GetRestitution();
-                def.friction = fixture->GetFriction();
-                b2PolygonShape boxShape;
+            return;
+        }
 
-                // Convert SFML scale to Box2D size
-                float width = transform->getScale()->x;
-                float height = transform->getScale()->y;
+        b2Fixture *fixture = body->GetFixtureList(); // Get pointer to the fixture
+        b2FixtureDef def;
+        def.density = fixture->GetDensity();
+        def.restitution = fixture->GetRestitution();
+        def.friction = fixture->GetFriction();
+        def.filter = fixture->GetFilterData();
+        b2PolygonShape boxShape;
 
-                // Set the shape centered around the position
-                boxShape.SetAsBox(width / 2.0f, height / 2.0f, b2Vec2(width / 2.0f, height / 2.0f), 0.0f);
+        // Convert SFML scale to Box2D size
+        float width = scale.x;
+        float height = scale.y;
 
-                def.shape = &boxShape;
+        // Set the shape centered around the position
+        boxShape.SetAsBox(width / 2.0f, height / 2.0f, b2Vec2(width / 2.0f, height / 2.0f), 0.0f);
 
-                // Destroy the old fixture
-                body->DestroyFixture(fixture);
+        def.shape = &boxShape;
 
-                // Create a new fixture with updated properties
-                body->CreateFixture(&def);
-            }
+        // Destroy the old fixture
+        body->DestroyFixture(fixture);
 
-            // TODO: update body shape
-        };
+        // Create a new fixture with updated properties
+        body->CreateFixture(&def);
+        m_fixtureScale = scale;
+    }
+
+    void PhysicsBody2D::applyFilter()
+    {
+        b2Fixture *fixture = body ? body->GetFixtureList() : nullptr;
+        if (!fixture)
+        {
+            return;
+        }
+
+        Layer layer = Entity::getLayer(entity.getId());
+        b2Filter filter = fixture->GetFilterData();
+        if (filter.categoryBits == layerBit(layer) && filter.maskBits == Box2DIntegration::getCollisionMask(layer))
+        {
+            return;
+        }
+
+        filter.categoryBits = layerBit(layer);
+        filter.maskBits = Box2DIntegration::getCollisionMask(layer);
+        fixture->SetFilterData(filter);
     }
 
     void PhysicsBody2D::start()
@@ -81,10 +108,28 @@ namespace wpwp
         syncTransform();
     }
 
-    void PhysicsBody2D::update()
+    void PhysicsBody2D::fixedUpdate()
+    {
+        // Changes made outside the simulation (e.g. in the editor) are pushed to the body first
+        if (body && pollTransformChanged())
+        {
+            pushTransform();
+        }
+
+        // Two compares a step, so layer and collision matrix changes need no notification
+        applyFilter();
+    }
+
+    void PhysicsBody2D::onWorldStepped()
     {
         syncTransform();
 
+        // Writing the simulated transform back isn't a change this body has to push again
+        m_transformTick = ChangeTicks::observe();
+    }
+
+    void PhysicsBody2D::update()
+    {
 #ifdef DEBUG
         const float lineThickness = 2.0f; // Adjust thickness as desired
 
@@ -119,7 +164,7 @@ namespace wpwp
                         line.setRotation(angle);
                         line.setFillColor(sf::Color::White);
 
-                        Engine::getInstance()->draw(line);
+                        Engine::getInstance()->submit(line);
                     }
                 }
                 else
@@ -148,6 +193,26 @@ namespace wpwp
         }
     }
 
+    void PhysicsBody2D::onDisable()
+    {
+        if (body)
+        {
+            body->SetEnabled(false);
+        }
+    }
+
+    void PhysicsBody2D::onEnable()
+    {
+        if (body)
+        {
+            pushTransform();
+            body->SetLinearVelocity(b2Vec2_zero);
+            body->SetAngularVelocity(0.0f);
+            body->SetEnabled(true);
+            m_transformTick = ChangeTicks::observe();
+        }
+    }
+
     PhysicsBody2D::~PhysicsBody2D()
     {
         if (m_world && body)
@@ -234,4 +299,56 @@ namespace wpwp
         else
             ERROR("BODY IS MISSING");
     }
+
+    int PhysicsBody2D::getBodyType() const
+    {
+        return body ? static_cast<int>(body->GetType()) : static_cast<int>(b2_staticBody);
+    }
+
+    void PhysicsBody2D::setBodyType(int type)
+    {
+        if (body)
+            body->SetType(static_cast<b2BodyType>(type));
+        else
+            ERROR("BODY IS MISSING");
+    }
+
+    float PhysicsBody2D::getDensity() const
+    {
+        return body && body->GetFixtureList() ? body->GetFixtureList()->GetDensity() : 0.0f;
+    }
+
+    void PhysicsBody2D::setDensity(float density)
+    {
+        if (body && body->GetFixtureList())
+            body->GetFixtureList()->SetDensity(density);
+        else
+            ERROR("BODY IS MISSING");
+    }
+
+    float PhysicsBody2D::getFriction() const
+    {
+        return body && body->GetFixtureList() ? body->GetFixtureList()->GetFriction() : 0.0f;
+    }
+
+    void PhysicsBody2D::setFriction(float friction)
+    {
+        if (body && body->GetFixtureList())
+            body->GetFixtureList()->SetFriction(friction);
+        else
+            ERROR("BODY IS MISSING");
+    }
+
+    float PhysicsBody2D::getRestitution() const
+    {
+        return body && body->GetFixtureList() ? body->GetFixtureList()->GetRestitution() : 0.0f;
+    }
+
+    void PhysicsBody2D::setRestitution(float restitution)
+    {
+        if (body && body->GetFixtureList())
+            body->GetFixtureList()->SetRestitution(restitution);
+        else
+            ERROR("BODY IS MISSING");
+    }
 }
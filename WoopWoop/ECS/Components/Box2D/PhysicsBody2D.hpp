@@ -25,10 +25,30 @@ namespace wpwp
         void start() override;
 
         /**
-         * @brief Called every frame to update the component.
+         * @brief Called every frame to update the component, draws the fixtures in debug builds.
          */
         void update() override;
 
+        /**
+         * @brief Called every simulation step before the world steps, pushes transform and layer changes to the body.
+         */
+        void fixedUpdate() override;
+
+        /**
+         * @brief Called by Box2DIntegration after the world stepped, writes the body's new position back to the transform.
+         */
+        void onWorldStepped();
+
+        /**
+         * @brief Takes the body out of the simulation.
+         */
+        void onDisable() override;
+
+        /**
+         * @brief Puts the body back in the simulation at the transform, at rest.
+         */
+        void onEnable() override;
+
         /**
          * @brief Gets the name of the component.
          *
@@ -46,12 +66,34 @@ namespace wpwp
         bool getRotationFixed() const { return m_isRotationFixed; }
         void setRotationFixed(bool state);
 
+        int getBodyType() const;
+        void setBodyType(int type);
+
+        float getDensity() const;
+        void setDensity(float density);
+
+        float getFriction() const;
+        void setFriction(float friction);
+
+        float getRestitution() const;
+        void setRestitution(float restitution);
+
     private:
         /**
          * @brief Syncs the transform with the Box2D body.
          */
         void syncTransform();
 
+        /**
+         * @brief Moves the Box2D body to the transform, recreating the fixture if the scale changed.
+         */
+        void pushTransform();
+
+        /**
+         * @brief Sets the fixture's collision filter from the entity's layer, if it changed.
+         */
+        void applyFilter();
+
         /**
          * @brief Initializes the Rigidbody with a Box2D world and body definition.
          *
@@ -63,9 +105,15 @@ namespace wpwp
     private:
         b2World *m_world; // Pointer to the Box2D world
         bool m_isRotationFixed = false;
+        sf::Vector2f m_fixtureScale; // Scale the fixture was last built for, zero until the first push.
     };
 
-    WREGISTER(PhysicsBody2D)
+    WREGISTER(PhysicsBody2D,
+              WPROPERTY("Body Type", self.getBodyType(), self.setBodyType(value)),
+              WPROPERTY("Density", self.getDensity(), self.setDensity(value)),
+              WPROPERTY("Friction", self.getFriction(), self.setFriction(value)),
+              WPROPERTY("Restitution", self.getRestitution(), self.setRestitution(value)),
+              WPROPERTY("Rotation Fixed", self.getRotationFixed(), self.setRotationFixed(value)))
 }
 
 #endif // RIGIDBODY_HPP
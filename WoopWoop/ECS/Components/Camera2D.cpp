@@ -9,37 +9,23 @@ namespace wpwp
     void Camera2D::start()
     {
         m_view = Engine::getInstance()->window.getDefaultView();
+    };
 
-        transform->onTransformChanged += [&]()
+    void Camera2D::update()
+    {
+        if (pollTransformChanged())
         {
             sf::Vector3f position = *transform->getPosition();
             setCenter({position.x, position.y});
 
             sf::Vector3f rotation = *transform->getRotation();
             m_view.setRotation(rotation.z);
-        };
-    };
-
-    void Camera2D::update()
-    {
-        if (isMain)
-        {
-            Engine::getInstance()->m_renderTexture.setView(m_view);
         }
-    }
-
-    void Camera2D::onDrawGUI()
-    {
-        bool prevMain = isMain;
 
-        ImGui::Checkbox("Main", &isMain);
-        // TODO: change all other camera to not being main if the current one is main
-
-        float v[2] = {getViewSize().x, getViewSize().y};
-
-        if (ImGui::InputFloat2("View Size", v))
+        if (isMain)
         {
-            setViewSize({v[0], v[1]});
+            Engine::getInstance()->submitView(m_view);
+            Engine::getInstance()->setRenderLayers(cullingMask);
         }
     }
 
@@ -23,9 +23,8 @@ namespace wpwp
          */
         void update() override;
 
-        bool isMain; // Flag indicating whether the camera is the main camera.
-
-        void onDrawGUI() override;
+        bool isMain;                        // Flag indicating whether the camera is the main camera.
+        LayerMask cullingMask = ALL_LAYERS; // Layers drawn while the camera is the main camera.
 
         /**
          * @brief Gets the name of the component.
@@ -45,7 +44,10 @@ namespace wpwp
         sf::View m_view; // SFML view associated with the camera.
     };
 
-    WREGISTER(Camera2D);
+    WREGISTER(Camera2D,
+              WFIELD("IsMain", isMain),
+              WPROPERTY("Culling Mask", int(self.cullingMask), self.cullingMask = static_cast<LayerMask>(value)),
+              WPROPERTY("View Size", self.getViewSize(), self.setViewSize(value)));
 } // namespace wpwp
 
 #endif // CAMERA_HPP
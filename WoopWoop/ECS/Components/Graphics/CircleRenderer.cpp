@@ -6,20 +6,25 @@ namespace wpwp
     {
         m_circleShape = sf::CircleShape(entity->transform->getScale()->x);
         material.color = sf::Color::White;
-
-        transform->onTransformChanged += [&]()
-        {
-            sf::Vector2f pos(entity->transform->getPosition()->x, entity->transform->getPosition()->y);
-            m_circleShape.setPosition(pos);
-            m_circleShape.setRadius(0.5);
-            m_circleShape.setScale(sf::Vector2f(entity->transform->getScale()->x, entity->transform->getScale()->y));
-            m_circleShape.setRotation(entity->transform->getRotation()->z);
-        };
     }
 
     void CircleRenderer::update()
     {
+        if (pollDrawnTransform())
+        {
+            sf::Vector3f position = getDrawnPosition();
+            m_circleShape.setPosition(sf::Vector2f(position.x, position.y));
+            m_circleShape.setRadius(0.5);
+            m_circleShape.setScale(sf::Vector2f(transform->getScale()->x, transform->getScale()->y));
+            m_circleShape.setRotation(getDrawnRotation().z);
+        }
+
+        if (!wpwp::Engine::getInstance()->isLayerRendered(Entity::getLayer(entity.getId())))
+        {
+            return;
+        }
+
         m_circleShape.setFillColor(material.color);
-        wpwp::Engine::getInstance()->draw(m_circleShape);
+        wpwp::Engine::getInstance()->submit(m_circleShape);
     }
 };
\ No newline at end of file
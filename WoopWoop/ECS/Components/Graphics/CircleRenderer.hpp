@@ -33,7 +33,8 @@ namespace wpwp
         sf::CircleShape m_circleShape; // Circle shape to render.
     };
 
-    WREGISTER(CircleRenderer)
+    WREGISTER(CircleRenderer,
+              WFIELD("Color", material.color).inGroup("Material"))
 } // namespace wpwp
 
 #endif // CIRCLE_RENDERER_HPP
@@ -1,18 +1,32 @@
-#include "Renderer.hpp"
-#include "imgui/imgui.h"
+#include "WoopWoop.hpp"
 
-void wpwp::Renderer::onDrawGUI()
+namespace wpwp
 {
-    float col[4] = {
-        material.color.r / 255.0f,
-        material.color.g / 255.0f,
-        material.color.b / 255.0f,
-        material.color.a / 255.0f};
+    bool Renderer::pollDrawnTransform()
+    {
+        const bool changed = pollTransformChanged();
+        const bool interpolating = transform && transform->isInterpolating();
+        const bool sync = changed || interpolating || m_wasInterpolating;
+        m_wasInterpolating = interpolating;
+        return sync;
+    }
 
-    ImGui::ColorEdit4("Color", col);
+    namespace
+    {
+        float interpolationAlpha()
+        {
+            Engine *engine = Engine::getInstance();
+            return engine ? engine->getInterpolationAlpha() : 1.0f;
+        }
+    }
 
-    material.color.r = col[0] * 255.0f;
-    material.color.g = col[1] * 255.0f;
-    material.color.b = col[2] * 255.0f;
-    material.color.a = col[3] * 255.0f;
-}
\ No newline at end of file
+    sf::Vector3f Renderer::getDrawnPosition() const
+    {
+        return transform->getInterpolatedPosition(interpolationAlpha());
+    }
+
+    sf::Vector3f Renderer::getDrawnRotation() const
+    {
+        return transform->getInterpolatedRotation(interpolationAlpha());
+    }
+} // namespace wpwp
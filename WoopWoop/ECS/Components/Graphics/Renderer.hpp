@@ -1,6 +1,7 @@
 #ifndef RENDERER_HPP
 #define RENDERER_HPP
 
+#include <SFML/System/Vector3.hpp>
 #include "ECS/Component.hpp"
 #include "Material.hpp"
 
@@ -13,7 +14,28 @@ namespace wpwp
     {
     public:
         Material material{}; ///< Material associated with the renderer.
-        virtual void onDrawGUI() override;
+
+    protected:
+        /**
+         * @brief Checks if the drawn shape has to be synced with the transform this frame.
+         * True when the transform changed, while it's interpolating, and on the frame after so the shape lands on the final values.
+         *
+         * @return True if the shape has to be synced.
+         */
+        bool pollDrawnTransform();
+
+        /**
+         * @brief Gets the position to draw at, interpolated between the last two simulation steps.
+         */
+        sf::Vector3f getDrawnPosition() const;
+
+        /**
+         * @brief Gets the rotation to draw with, interpolated between the last two simulation steps.
+         */
+        sf::Vector3f getDrawnRotation() const;
+
+    private:
+        bool m_wasInterpolating = false; ///< Flag indicating whether the last sync drew an interpolated transform.
     };
 } // namespace wpwp
 
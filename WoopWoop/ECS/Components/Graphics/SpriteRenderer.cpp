@@ -1,6 +1,5 @@
 #include "SpriteRenderer.hpp"
 #include <iostream>
-#include <cstring>
 
 namespace wpwp
 {
@@ -14,24 +13,16 @@ namespace wpwp
                 ERROR("Failed to load texture from file: ", path);
                 return;
             }
-            m_texture = tempTexture;
+            // A new texture rather than overwriting, a frame recorded for the render thread may still draw the old one
+            m_texture = std::make_shared<sf::Texture>(std::move(tempTexture));
             m_filePath = path;
-            loadTexture(&m_texture);
+            loadTexture(m_texture.get());
         }
     }
 
     void SpriteRenderer::onDrawGUI()
     {
-        static char filePathBuffer[256];
-
-        // Copy the file path to the buffer ensuring null-termination
-        std::strncpy(filePathBuffer, m_filePath.c_str(), sizeof(filePathBuffer) - 1);
-        filePathBuffer[sizeof(filePathBuffer) - 1] = '\0'; // Ensure null termination
-
-        if (ImGui::InputText("File Path", filePathBuffer, sizeof(filePathBuffer)))
-        {
-            loadSprite(std::string(filePathBuffer));
-        }
+        Component::onDrawGUI();
 
         if (sprite.getTexture() != nullptr)
         {
@@ -43,28 +34,26 @@ namespace wpwp
             ImGui::Image(textureID, size);
             ImGui::Dummy({0.0f, 3.0f});
         }
-
-        // Update m_filePath after interacting with the GUI
-        m_filePath = std::string(filePathBuffer);
-
-        // Call the base class onDrawGUI if it exists
-        this->Renderer::onDrawGUI();
     }
 
     void SpriteRenderer::loadTexture(sf::Texture *texture)
     {
         sprite.setTexture(*texture);
+
+        // The scale depends on the texture size, resync on the next update
+        m_transformTick = 0;
     }
 
     void SpriteRenderer::syncTransform()
     {
-        sf::Vector2f pos(entity->transform->getPosition()->x, entity->transform->getPosition()->y);
+        sf::Vector3f position = getDrawnPosition();
+        sf::Vector2f pos(position.x, position.y);
 
         if (sprite.getTexture() && transform->getScale()->x != 0 && transform->getScale()->y != 0)
         {
             // Apply the transform scale to the sprite
             sf::Vector2f transformScale{transform->getScale()->x, transform->getScale()->y};
-            sf::Vector2u textureSize = m_texture.getSize();
+            sf::Vector2u textureSize = m_texture->getSize();
 
             // Ensure textureSize is not zero to avoid division by zero
             if (textureSize.x != 0 && textureSize.y != 0)
@@ -74,7 +63,7 @@ namespace wpwp
                     transformScale.y / static_cast<float>(textureSize.y));
             }
 
-            sprite.setRotation(entity->transform->getRotation()->z);
+            sprite.setRotation(getDrawnRotation().z);
             sprite.setColor(material.color);
             sprite.setPosition(pos);
         }
@@ -82,22 +71,28 @@ namespace wpwp
 
     void SpriteRenderer::update()
     {
-        if (sprite.getTexture() && transform && m_texture.getSize().x > 0 && m_texture.getSize().y > 0)
+        if (pollDrawnTransform())
+        {
+            syncTransform();
+        }
+
+        if (!Engine::getInstance()->isLayerRendered(Entity::getLayer(entity.getId())))
+        {
+            return;
+        }
+
+        if (sprite.getTexture() && transform && m_texture->getSize().x > 0 && m_texture->getSize().y > 0)
         {
             unsigned int scalar = 2;
-            sf::Vector2f origin = sf::Vector2f(m_texture.getSize() / scalar);
+            sf::Vector2f origin = sf::Vector2f(m_texture->getSize() / scalar);
             sprite.setOrigin(origin);
-            Engine::getInstance()->draw(sprite);
+            Engine::getInstance()->submit(sprite, m_texture);
         }
     }
 
     void SpriteRenderer::start()
     {
-        transform->onTransformChanged += [this]()
-        {
-            this->syncTransform();
-        };
-
         syncTransform();
+        m_transformTick = ChangeTicks::observe();
     }
 } // namespace wpwp
\ No newline at end of file
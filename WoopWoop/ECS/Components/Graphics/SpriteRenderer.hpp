@@ -47,11 +47,13 @@ namespace wpwp
         void syncTransform();
 
     private:
-        sf::Texture m_texture; // Texture associated with the sprite.
+        std::shared_ptr<sf::Texture> m_texture = std::make_shared<sf::Texture>(); // Texture associated with the sprite, shared with the render lists drawing it.
         std::string m_filePath = "";
     };
 
-    WREGISTER(SpriteRenderer)
+    WREGISTER(SpriteRenderer,
+              WPROPERTY("SpritePath", self.getFilePath(), self.loadSprite(value)),
+              WFIELD("Color", material.color).inGroup("Material"))
 } // namespace wpwp
 
 #endif // SPRITE_RENDERER_HPP
@@ -1,51 +1,427 @@
 #include "Transform.hpp"
+#include "Util/ThreadPool.hpp"
+#include <cmath>
+#include <mutex>
 
 namespace wpwp
 {
+    std::vector<EntityId> Transform::s_changedParents;
+    std::vector<EntityId> Transform::s_moved;
+    std::atomic<std::uint64_t> Transform::s_movedBatch = 1;
+    std::uint64_t Transform::s_fixedStep = 0;
+    bool Transform::s_inFixedStep = false;
+
+    namespace
+    {
+        sf::Transform toMatrix(const sf::Vector3f &position, const sf::Vector3f &rotation, const sf::Vector3f &scale)
+        {
+            sf::Transform matrix;
+            matrix.translate(position.x, position.y).rotate(rotation.z).scale(scale.x, scale.y);
+            return matrix;
+        }
+
+        float divideScale(float scale, float parentScale)
+        {
+            return parentScale != 0 ? scale / parentScale : scale;
+        }
+
+        std::vector<Transform *> s_level;   // Scratch buffer of the hierarchy level being propagated.
+        std::vector<Transform *> s_next;    // Scratch buffer of the level below it.
+        std::vector<Transform *> s_changed; // Scratch buffer of every transform propagated in the current call.
+        std::vector<EntityId> s_queued;     // Scratch buffer the changed parents are taken into.
+
+        std::mutex s_changedMutex; // Guards the changed parents and moved ids, setters run on scheduler workers and the simulation thread.
+    }
+
     sf::Vector3f *Transform::getPosition() { return &m_globalPosition; }
 
     void Transform::setPosition(const sf::Vector3f &position)
     {
+        if (m_globalPosition == position)
+        {
+            return;
+        }
+
+        snapshot();
         m_globalPosition = position;
-        onTransformChanged.invoke();
+        updateLocalFromWorld();
+        notifyChanged();
     }
 
     sf::Vector3f *Transform::getRotation() { return &m_rotation; }
 
     void Transform::setRotation(const sf::Vector3f &rotation)
     {
+        if (m_rotation == rotation)
+        {
+            return;
+        }
+
+        snapshot();
         m_rotation = rotation;
-        onTransformChanged.invoke();
+        updateLocalFromWorld();
+        notifyChanged();
     }
 
     sf::Vector3f *Transform::getScale() { return &m_scale; }
 
     void Transform::setScale(const sf::Vector3f &scale)
     {
+        if (m_scale == scale)
+        {
+            return;
+        }
+
+        snapshot();
         m_scale = scale;
+        updateLocalFromWorld();
+        notifyChanged();
+    }
+
+    void Transform::setLocalPosition(const sf::Vector3f &position)
+    {
+        if (m_localPosition == position)
+        {
+            return;
+        }
+
+        snapshot();
+        m_localPosition = position;
+        updateWorldFromLocal(getParentTransform());
+        notifyChanged();
+    }
+
+    void Transform::setLocalRotation(const sf::Vector3f &rotation)
+    {
+        if (m_localRotation == rotation)
+        {
+            return;
+        }
+
+        snapshot();
+        m_localRotation = rotation;
+        updateWorldFromLocal(getParentTransform());
+        notifyChanged();
+    }
+
+    void Transform::setLocalScale(const sf::Vector3f &scale)
+    {
+        if (m_localScale == scale)
+        {
+            return;
+        }
+
+        snapshot();
+        m_localScale = scale;
+        updateWorldFromLocal(getParentTransform());
+        notifyChanged();
+    }
+
+    Transform *Transform::getParentTransform() const
+    {
+        Entity *parent = Entity::get(m_parent);
+        return parent ? parent->transform : nullptr;
+    }
+
+    void Transform::updateLocalFromWorld()
+    {
+        const Transform *parent = getParentTransform();
+        if (!parent)
+        {
+            m_localPosition = m_globalPosition;
+            m_localRotation = m_rotation;
+            m_localScale = m_scale;
+        }
+        else
+        {
+            sf::Vector2f position = parent->m_worldMatrix.getInverse().transformPoint(m_globalPosition.x, m_globalPosition.y);
+            m_localPosition = {position.x, position.y, m_globalPosition.z - parent->m_globalPosition.z};
+            m_localRotation = m_rotation - parent->m_rotation;
+            m_localScale = {divideScale(m_scale.x, parent->m_scale.x),
+                            divideScale(m_scale.y, parent->m_scale.y),
+                            divideScale(m_scale.z, parent->m_scale.z)};
+        }
+
+        m_localMatrix = toMatrix(m_localPosition, m_localRotation, m_localScale);
+        m_worldMatrix = parent ? parent->m_worldMatrix * m_localMatrix : m_localMatrix;
+    }
+
+    void Transform::updateWorldFromLocal(const Transform *parent)
+    {
+        m_localMatrix = toMatrix(m_localPosition, m_localRotation, m_localScale);
+        if (!parent)
+        {
+            m_worldMatrix = m_localMatrix;
+            m_globalPosition = m_localPosition;
+            m_rotation = m_localRotation;
+            m_scale = m_localScale;
+            return;
+        }
+
+        m_worldMatrix = parent->m_worldMatrix * m_localMatrix;
+        sf::Vector2f position = m_worldMatrix.transformPoint(0, 0);
+        m_globalPosition = {position.x, position.y, parent->m_globalPosition.z + m_localPosition.z};
+        m_rotation = parent->m_rotation + m_localRotation;
+        m_scale = {parent->m_scale.x * m_localScale.x, parent->m_scale.y * m_localScale.y, parent->m_scale.z * m_localScale.z};
+    }
+
+    void Transform::notifyChanged()
+    {
+        markChanged();
         onTransformChanged.invoke();
+
+        // Only this transform's own flags are read unlocked, whoever changes it owns it meanwhile
+        const std::uint64_t batch = s_movedBatch.load(std::memory_order_relaxed);
+        const bool track = m_movedBatch != batch;
+        const bool queue = !m_children.empty() && !m_queued;
+        if (!track && !queue)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(s_changedMutex);
+        if (track)
+        {
+            m_movedBatch = batch;
+            s_moved.push_back(entity.getId());
+        }
+        if (queue)
+        {
+            m_queued = true;
+            s_changedParents.push_back(entity.getId());
+        }
+    }
+
+    void Transform::snapshot()
+    {
+        if (!s_inFixedStep)
+        {
+            m_snapshotStep = 0;
+            return;
+        }
+
+        if (m_snapshotStep != s_fixedStep)
+        {
+            m_previousPosition = m_globalPosition;
+            m_previousRotation = m_rotation;
+            m_snapshotStep = s_fixedStep;
+        }
+    }
+
+    void Transform::beginFixedStep()
+    {
+        s_fixedStep++;
+        s_inFixedStep = true;
+    }
+
+    void Transform::endFixedStep()
+    {
+        s_inFixedStep = false;
+    }
+
+    sf::Vector3f Transform::getInterpolatedPosition(float alpha) const
+    {
+        if (!isInterpolating())
+        {
+            return m_globalPosition;
+        }
+        return m_previousPosition + (m_globalPosition - m_previousPosition) * alpha;
+    }
+
+    sf::Vector3f Transform::getInterpolatedRotation(float alpha) const
+    {
+        if (!isInterpolating())
+        {
+            return m_rotation;
+        }
+
+        sf::Vector3f rotation = m_previousRotation + (m_rotation - m_previousRotation) * alpha;
+        rotation.z = m_previousRotation.z + std::remainder(m_rotation.z - m_previousRotation.z, 360.0f) * alpha;
+        return rotation;
+    }
+
+    void Transform::propagateChanges()
+    {
+        {
+            std::lock_guard<std::mutex> lock(s_changedMutex);
+            if (s_changedParents.empty())
+            {
+                return;
+            }
+            s_queued.clear();
+            std::swap(s_queued, s_changedParents);
+        }
+
+        // A queued transform under another queued one is reached from the higher one anyway
+        s_level.clear();
+        for (EntityId id : s_queued)
+        {
+            Entity *queued = Entity::get(id);
+            if (!queued)
+            {
+                continue;
+            }
+
+            bool hasQueuedAncestor = false;
+            for (Transform *ancestor = queued->transform->getParentTransform(); ancestor; ancestor = ancestor->getParentTransform())
+            {
+                if (ancestor->m_queued)
+                {
+                    hasQueuedAncestor = true;
+                    break;
+                }
+            }
+
+            if (!hasQueuedAncestor)
+            {
+                s_level.push_back(queued->transform);
+            }
+        }
+
+        for (EntityId id : s_queued)
+        {
+            if (Entity *queued = Entity::get(id))
+            {
+                queued->transform->m_queued = false;
+            }
+        }
+
+        s_changed.clear();
+        while (!s_level.empty())
+        {
+            s_next.clear();
+            for (Transform *parent : s_level)
+            {
+                for (EntityId childId : parent->m_children)
+                {
+                    if (Entity *child = Entity::get(childId))
+                    {
+                        s_next.push_back(child->transform);
+                    }
+                }
+            }
+
+            // Siblings only read their parent, which is done by now, so a level can be split freely
+            ThreadPool::getInstance().parallelFor(s_next.size(), 256, [](std::size_t begin, std::size_t end)
+                                                  {
+                for (std::size_t i = begin; i < end; i++)
+                {
+                    s_next[i]->snapshot();
+                    s_next[i]->updateWorldFromLocal(s_next[i]->getParentTransform());
+                    s_next[i]->markChanged();
+                } });
+
+            s_changed.insert(s_changed.end(), s_next.begin(), s_next.end());
+            std::swap(s_level, s_next);
+        }
+
+        // Queued here on the calling thread, the listeners run at the end of the frame's update
+        for (Transform *changed : s_changed)
+        {
+            changed->onTransformChanged.invoke();
+        }
+
+        std::lock_guard<std::mutex> lock(s_changedMutex);
+        const std::uint64_t batch = s_movedBatch.load(std::memory_order_relaxed);
+        for (Transform *changed : s_changed)
+        {
+            if (changed->m_movedBatch != batch)
+            {
+                changed->m_movedBatch = batch;
+                s_moved.push_back(changed->entity.getId());
+            }
+        }
+    }
+
+    void Transform::takeMoved(std::vector<EntityId> &moved)
+    {
+        moved.clear();
+
+        // A new batch, so every transform is added again on its next change without clearing any flag
+        std::lock_guard<std::mutex> lock(s_changedMutex);
+        std::swap(moved, s_moved);
+        s_movedBatch++;
+    }
+
+    void Transform::setParent(EntityId parent)
+    {
+        if (parent == m_parent)
+        {
+            return;
+        }
+
+        // Walked up from the new parent, meeting this entity means it would become its own ancestor
+        for (Entity *ancestor = Entity::get(parent); ancestor && ancestor->transform; ancestor = Entity::get(ancestor->transform->m_parent))
+        {
+            if (ancestor->getId() == entity.getId())
+            {
+                ERROR("Can't parent an entity to itself or to one of its descendants");
+                return;
+            }
+        }
+
+        if (Transform *previous = getParentTransform())
+        {
+            auto &siblings = previous->m_children;
+            siblings.erase(std::remove(siblings.begin(), siblings.end(), entity.getId()), siblings.end());
+        }
+
+        Entity *newParent = Entity::get(parent);
+        m_parent = newParent ? parent : EntityId();
+        if (newParent && std::find(newParent->transform->m_children.begin(), newParent->transform->m_children.end(), entity.getId()) == newParent->transform->m_children.end())
+        {
+            newParent->transform->m_children.push_back(entity.getId());
+        }
+
+        // The world transform stays, only the local values are relative to something else now
+        updateLocalFromWorld();
+
+        if (Entity *self = entity.get())
+        {
+            self->refreshActiveInHierarchy();
+        }
+    }
+
+    void Transform::addChild(EntityId child)
+    {
+        Entity *childEntity = Entity::get(child);
+        if (!childEntity)
+        {
+            ERROR("Can't add a destroyed entity as a child");
+            return;
+        }
+
+        childEntity->transform->setParent(entity.getId());
     }
 
     void Transform::addChild(std::string name)
     {
-        if (std::find(m_childrenNames.begin(), m_childrenNames.end(), name) == m_childrenNames.end())
-            m_childrenNames.push_back(name);
+        auto child = Entity::getEntityWithName(name);
+        if (!child)
+        {
+            ERROR("No entity named ", name, " to add as a child");
+            return;
+        }
+        addChild(child->getId());
     }
 
     void Transform::addChild(std::shared_ptr<Entity> child)
     {
-        addChild(child->getName());
+        addChild(child->getId());
     }
 
-    std::vector<std::shared_ptr<Entity>> Transform::getChildren() const
+    void Transform::removeChild(EntityId child)
     {
-        return VectorUtil::select(m_childrenNames, [](std::string name)
-                                  { return Entity::getEntityWithName(name); });
+        Entity *childEntity = Entity::get(child);
+        if (childEntity && childEntity->transform->m_parent == entity.getId())
+        {
+            childEntity->transform->setParent(EntityId());
+        }
     }
 
     std::size_t Transform::getChildCount()
     {
-        return m_childrenNames.size();
+        return m_children.size();
     }
 
     void Transform::onDrawGUI()
@@ -58,33 +434,36 @@ namespace wpwp
         ImGui::Text("X");
         ImGui::PopStyleColor();
         ImGui::SameLine();
-        float posX = m_globalPosition.x;
+        float posX = m_localPosition.x;
         if (ImGui::InputFloat("##XPosition", &posX))
         {
-            m_globalPosition.x = posX;
-            onTransformChanged.invoke();
+            sf::Vector3f value = m_localPosition;
+            value.x = posX;
+            setLocalPosition(value);
         }
 
         ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.0f, 1.0f, 0.0f, 1.0f)); // Green
         ImGui::Text("Y");
         ImGui::PopStyleColor();
         ImGui::SameLine();
-        float posY = m_globalPosition.y;
+        float posY = m_localPosition.y;
         if (ImGui::InputFloat("##YPosition", &posY))
         {
-            m_globalPosition.y = posY;
-            onTransformChanged.invoke();
+            sf::Vector3f value = m_localPosition;
+            value.y = posY;
+            setLocalPosition(value);
         }
 
         ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.0f, 0.0f, 1.0f, 1.0f)); // Blue
         ImGui::Text("Z");
         ImGui::PopStyleColor();
         ImGui::SameLine();
-        float posZ = m_globalPosition.z;
+        float posZ = m_localPosition.z;
         if (ImGui::InputFloat("##ZPosition", &posZ))
         {
-            m_globalPosition.z = posZ;
-            onTransformChanged.invoke();
+            sf::Vector3f value = m_localPosition;
+            value.z = posZ;
+            setLocalPosition(value);
         }
 
         ImGui::Dummy(ImVec2(0.0f, 20.0f));
@@ -98,33 +477,36 @@ namespace wpwp
         ImGui::Text("X");
         ImGui::PopStyleColor();
         ImGui::SameLine();
-        float scaleX = m_scale.x;
+        float scaleX = m_localScale.x;
         if (ImGui::InputFloat("##XScale", &scaleX))
         {
-            m_scale.x = scaleX;
-            onTransformChanged.invoke();
+            sf::Vector3f value = m_localScale;
+            value.x = scaleX;
+            setLocalScale(value);
         }
 
         ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.0f, 1.0f, 0.0f, 1.0f)); // Green
         ImGui::Text("Y");
         ImGui::PopStyleColor();
         ImGui::SameLine();
-        float scaleY = m_scale.y;
+        float scaleY = m_localScale.y;
         if (ImGui::InputFloat("##YScale", &scaleY))
         {
-            m_scale.y = scaleY;
-            onTransformChanged.invoke();
+            sf::Vector3f value = m_localScale;
+            value.y = scaleY;
+            setLocalScale(value);
         }
 
         ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.0f, 0.0f, 1.0f, 1.0f)); // Blue
         ImGui::Text("Z");
         ImGui::PopStyleColor();
         ImGui::SameLine();
-        float scaleZ = m_scale.z;
+        float scaleZ = m_localScale.z;
         if (ImGui::InputFloat("##ZScale", &scaleZ))
         {
-            m_scale.z = scaleZ;
-            onTransformChanged.invoke();
+            sf::Vector3f value = m_localScale;
+            value.z = scaleZ;
+            setLocalScale(value);
         }
 
         ImGui::PopID();
@@ -138,33 +520,36 @@ namespace wpwp
         ImGui::Text("X");
         ImGui::PopStyleColor();
         ImGui::SameLine();
-        float rotX = m_rotation.x;
+        float rotX = m_localRotation.x;
         if (ImGui::InputFloat("##XRotation", &rotX))
         {
-            m_rotation.x = rotX;
-            onTransformChanged.invoke();
+            sf::Vector3f value = m_localRotation;
+            value.x = rotX;
+            setLocalRotation(value);
         }
 
         ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.0f, 1.0f, 0.0f, 1.0f)); // Green
         ImGui::Text("Y");
         ImGui::PopStyleColor();
         ImGui::SameLine();
-        float rotY = m_rotation.y;
+        float rotY = m_localRotation.y;
         if (ImGui::InputFloat("##YRotation", &rotY))
         {
-            m_rotation.y = rotY;
-            onTransformChanged.invoke();
+            sf::Vector3f value = m_localRotation;
+            value.y = rotY;
+            setLocalRotation(value);
         }
 
         ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.0f, 0.0f, 1.0f, 1.0f)); // Blue
         ImGui::Text("Z");
         ImGui::PopStyleColor();
         ImGui::SameLine();
-        float rotZ = m_rotation.z;
+        float rotZ = m_localRotation.z;
         if (ImGui::InputFloat("##ZRotation", &rotZ))
         {
-            m_rotation.z = rotZ;
-            onTransformChanged.invoke();
+            sf::Vector3f value = m_localRotation;
+            value.z = rotZ;
+            setLocalRotation(value);
         }
 
         ImGui::PopID();
@@ -2,62 +2,115 @@
 #define TRANSFORM_HPP
 
 #include "WoopWoop.hpp"
+#include <atomic>
 
 namespace wpwp
 {
     /**
      * @brief Component representing the transform of an entity.
+     *
+     * The local position, rotation and scale are relative to the parent's transform, the world ones are cached and derived from them.
+     * Changing a transform updates its own world values right away, its descendants are brought up to date by propagateChanges().
+     * Only the z rotation and the x and y axes go through the 2D matrices, the other components are added (or multiplied for scale) down the hierarchy.
      */
     class Transform : public Component
     {
     public:
 #pragma region World Position
         /**
-         * @brief Gets the position of the transform.
+         * @brief Gets the world position of the transform.
          *
          * @return A pointer to the position vector.
          */
         sf::Vector3f *getPosition();
 
         /**
-         * @brief Sets the position of the transform.
+         * @brief Sets the world position of the transform, setting the current value doesn't count as a change.
          *
          * @param position The new position vector.
          */
         void setPosition(const sf::Vector3f &position);
 
         /**
-         * @brief Gets the rotation of the transform.
+         * @brief Gets the world rotation of the transform.
          *
          * @return A pointer to the rotation vector.
          */
         sf::Vector3f *getRotation();
 
         /**
-         * @brief Sets the rotation of the transform.
+         * @brief Sets the world rotation of the transform, setting the current value doesn't count as a change.
          *
          * @param rotation The new rotation vector.
          */
         void setRotation(const sf::Vector3f &rotation);
 
         /**
-         * @brief Gets the scale of the transform.
+         * @brief Gets the world scale of the transform.
+         * Approximate when a parent is both rotated and scaled unevenly, since a matrix with skew can't be described by a scale.
          *
          * @return A pointer to the scale vector.
          */
         sf::Vector3f *getScale();
 
         /**
-         * @brief Sets the scale of the transform.
+         * @brief Sets the world scale of the transform, setting the current value doesn't count as a change.
          *
          * @param scale The new scale vector.
          */
         void setScale(const sf::Vector3f &scale);
+
+        /**
+         * @brief Gets the matrix from the entity's space to world space.
+         *
+         * @return The cached world matrix.
+         */
+        const sf::Transform &getWorldMatrix() const { return m_worldMatrix; }
 #pragma endregion World Position
 
+#pragma region Local Position
+        const sf::Vector3f &getLocalPosition() const { return m_localPosition; }
+        void setLocalPosition(const sf::Vector3f &position);
+
+        const sf::Vector3f &getLocalRotation() const { return m_localRotation; }
+        void setLocalRotation(const sf::Vector3f &rotation);
+
+        const sf::Vector3f &getLocalScale() const { return m_localScale; }
+        void setLocalScale(const sf::Vector3f &scale);
+
+        /**
+         * @brief Gets the matrix from the entity's space to its parent's space.
+         *
+         * @return The cached local matrix.
+         */
+        const sf::Transform &getLocalMatrix() const { return m_localMatrix; }
+#pragma endregion Local Position
+
 #pragma region Child Parent Relation
         /**
-         * @brief Adds a child entity by name.
+         * @brief Gets the id of the parent entity.
+         *
+         * @return The parent's id, invalid for root entities.
+         */
+        EntityId getParent() const { return m_parent; }
+
+        /**
+         * @brief Moves the entity under a new parent, keeping its world transform.
+         * Refused with an error if the new parent is the entity itself or one of its descendants.
+         *
+         * @param parent The id of the new parent, an invalid id makes the entity a root.
+         */
+        void setParent(EntityId parent);
+
+        /**
+         * @brief Adds a child entity by id.
+         *
+         * @param child The id of the child entity.
+         */
+        void addChild(EntityId child);
+
+        /**
+         * @brief Adds a child entity by name, resolving the name once.
          *
          * @param name The name of the child entity.
          */
@@ -71,11 +124,18 @@ namespace wpwp
         void addChild(std::shared_ptr<Entity> child);
 
         /**
-         * @brief Gets the list of child entities.
+         * @brief Makes a child entity a root, keeping its world transform.
          *
-         * @return A vector of pointers to the child entities.
+         * @param child The id of the child entity.
          */
-        std::vector<std::shared_ptr<Entity>> getChildren() const;
+        void removeChild(EntityId child);
+
+        /**
+         * @brief Gets the ids of the child entities.
+         *
+         * @return The ids of the child entities.
+         */
+        const std::vector<EntityId> &getChildren() const { return m_children; }
 
         /**
          * @brief Gets the count of child entities.
@@ -85,10 +145,64 @@ namespace wpwp
         std::size_t getChildCount();
 #pragma endregion Child Parent Relation
 
+        /**
+         * @brief Recomputes the world transform of every descendant of the transforms changed since the last call.
+         *
+         * Runs breadth first, one level of the hierarchy at a time, so every parent is done before its children.
+         * Each level is split across the thread pool, the changed descendants are then marked and their signals queued on the calling thread.
+         * Transforms may be changed from any thread between two calls (systems on the thread pool, the pipelined simulation thread),
+         * the changed parents are queued under a lock. The call itself must happen at a point where nothing else touches transforms.
+         */
+        static void propagateChanges();
+
+        /**
+         * @brief Takes the ids of the entities whose world transform changed since the last call, each once.
+         * Meant for a single consumer, the spatial index, called at the same points as propagateChanges() and after it.
+         *
+         * @param moved Receives the ids, its previous content is dropped and its storage reused for the next batch.
+         */
+        static void takeMoved(std::vector<EntityId> &moved);
+
+        /**
+         * @brief Starts a simulation step, transforms changed until endFixedStep() remember their world values from before the step.
+         * Changes made outside a step aren't interpolated, the transform jumps to its new values.
+         */
+        static void beginFixedStep();
+
+        /**
+         * @brief Ends the simulation step started by beginFixedStep().
+         */
+        static void endFixedStep();
+
+        /**
+         * @brief Checks if the transform changed during the last simulation step, renderers then draw it interpolated.
+         *
+         * @return True if the world values before and after the step differ.
+         */
+        bool isInterpolating() const { return m_snapshotStep != 0 && m_snapshotStep == s_fixedStep; }
+
+        /**
+         * @brief Gets the world position between its values before and after the last simulation step.
+         *
+         * @param alpha How far between the two, from 0 (before) to 1 (after), see Engine::getInterpolationAlpha().
+         * @return The interpolated position, the current one if the transform isn't interpolating.
+         */
+        sf::Vector3f getInterpolatedPosition(float alpha) const;
+
+        /**
+         * @brief Gets the world rotation between its values before and after the last simulation step, z takes the shortest way around.
+         *
+         * @param alpha How far between the two, from 0 (before) to 1 (after), see Engine::getInterpolationAlpha().
+         * @return The interpolated rotation, the current one if the transform isn't interpolating.
+         */
+        sf::Vector3f getInterpolatedRotation(float alpha) const;
+
         /**
          * @brief A signal that is invoked whenever the transform is changed.
+         * Deferred, the listeners are called once per frame by DeferredSignals::flush() however many setters ran.
+         * Components mirroring the transform every frame should poll changedSince() instead.
          */
-        Signal<> onTransformChanged;
+        Signal<> onTransformChanged = Signal<>::deferred();
 
         /**
          * @brief Gets the name of the component.
@@ -99,14 +213,66 @@ namespace wpwp
         virtual void onDrawGUI() override;
 
     private:
+        /**
+         * @brief Gets the transform of the parent entity.
+         *
+         * @return Pointer to the parent's transform, or nullptr for root entities.
+         */
+        Transform *getParentTransform() const;
+
+        /**
+         * @brief Recomputes the local values from the world ones, after a world setter.
+         */
+        void updateLocalFromWorld();
+
+        /**
+         * @brief Recomputes the world values from the local ones and the parent's cached world values.
+         *
+         * @param parent The parent's transform, or nullptr for root entities.
+         */
+        void updateWorldFromLocal(const Transform *parent);
+
+        /**
+         * @brief Marks the transform changed, notifies the listeners and queues the descendants for propagation.
+         */
+        void notifyChanged();
+
+        /**
+         * @brief Remembers the world values before the first change of a simulation step, called before every change.
+         */
+        void snapshot();
+
+    private:
+        sf::Vector3f m_localPosition;                         // Position relative to the parent.
+        sf::Vector3f m_localScale = sf::Vector3f(1, 1, 1);    // Scale relative to the parent.
+        sf::Vector3f m_localRotation = sf::Vector3f(0, 0, 0); // Rotation relative to the parent.
+        sf::Transform m_localMatrix;                          // Cached matrix of the local values.
+
         sf::Vector3f m_globalPosition;                   // Global position of the entity.
         sf::Vector3f m_scale = sf::Vector3f(1, 1, 1);    // Scale of the entity.
         sf::Vector3f m_rotation = sf::Vector3f(0, 0, 0); // Rotation of the entity.
+        sf::Transform m_worldMatrix;                     // Cached matrix of the world values.
+
+        EntityId m_parent;                // Id of the parent entity, invalid for roots.
+        std::vector<EntityId> m_children; // Ids of the child entities.
+        bool m_queued = false;            // Flag indicating whether the descendants are queued for propagation.
+        std::uint64_t m_movedBatch = 0;   // Batch of moved ids the entity was last added to.
+
+        sf::Vector3f m_previousPosition;  // World position before the last simulation step that changed it.
+        sf::Vector3f m_previousRotation;  // World rotation before the last simulation step that changed it.
+        std::uint64_t m_snapshotStep = 0; // Step the previous values were taken at, 0 if changed outside a step since.
 
-        std::vector<std::string> m_childrenNames; // Names of the child entities.
+        static std::vector<EntityId> s_changedParents;  // Entities whose descendants have to be propagated, guarded by a lock.
+        static std::vector<EntityId> s_moved;           // Entities moved since the last takeMoved(), guarded by the same lock.
+        static std::atomic<std::uint64_t> s_movedBatch; // Current batch of moved ids, only advanced by takeMoved().
+        static std::uint64_t s_fixedStep;               // Simulation steps started so far.
+        static bool s_inFixedStep;                      // Flag indicating whether a simulation step is running.
     };
 
-    WREGISTER(Transform)
+    WREGISTER(Transform,
+              WPROPERTY("Position", *self.getPosition(), self.setPosition(value)).inGroup("Translation"),
+              WPROPERTY("Rotation", *self.getRotation(), self.setRotation(value)).inGroup("Translation"),
+              WPROPERTY("Scale", *self.getScale(), self.setScale(value)).inGroup("Translation"))
 
 } // namespace wpwp
 
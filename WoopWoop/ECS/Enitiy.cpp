@@ -2,24 +2,38 @@
 #include <iostream>
 #include "Util/Util.hpp"
 #include "ECS/Components/Transform.hpp"
+#include "ECS/Prefab.hpp"
 #include "WoopWoop.hpp"
 
 namespace wpwp
 {
 
+    // Defined first so the entity table outlives every entity during static destruction
+    std::vector<Entity::EntitySlot> Entity::s_slots{};
+    std::vector<std::uint32_t> Entity::s_freeSlots{};
     std::vector<std::shared_ptr<Entity>> Entity::s_entities{};
     std::unordered_map<std::string, std::shared_ptr<Entity>> Entity::s_nameToEntity{};
     std::unordered_map<std::string, int> Entity::s_nameCount;
-    Signal<std::shared_ptr<Entity>> Entity::onEntityInstantiated;
-    Signal<std::shared_ptr<Entity>> Entity::onEntityDestroyed;
+    std::unordered_map<ComponentMask, std::vector<std::shared_ptr<Entity>>> Entity::s_recycled;
+    Signal<> Entity::onAllEntitiesDestroyed;
+    Signal<std::span<const EntityId>> Entity::onEntitiesCreated;
+    Signal<std::span<const EntityId>> Entity::onEntitiesDestroyed;
+    Entity::LifecycleBatch Entity::s_pendingEvents;
+    Entity::LifecycleBatch Entity::s_flushingEvents;
 
     Entity::Entity(sf::Vector3f initialPosition) : Entity(initialPosition, DEFAULT_ENTITY_NAME)
     {
     }
 
-    Entity::Entity(sf::Vector3f initialPosition, std::string name) : transform(new Transform()), m_name(name)
+    Entity::Entity(sf::Vector3f initialPosition, std::string name) : Entity(std::move(name), ComponentList{})
     {
-        this->m_components = std::vector<std::shared_ptr<Component>>();
+        transform->setPosition(initialPosition);
+        transform->setRotation(sf::Vector3f(0, 0, 0));
+    }
+
+    Entity::Entity(std::string name, ComponentList components) : m_name(name)
+    {
+        acquireId();
 
         if (s_nameToEntity.find(name) != s_nameToEntity.end())
         {
@@ -28,38 +42,157 @@ namespace wpwp
         }
 
         this->m_name = name;
-        this->transform = addComponent<Transform>();
-        transform->setPosition(initialPosition);
-        transform->setRotation(sf::Vector3f(0, 0, 0));
+
+        const ComponentTypeId transformType = ComponentTypes::get<Transform>();
+        bool hasTransform = std::any_of(components.begin(), components.end(), [&](const auto &entry)
+                                        { return entry.first == transformType; });
+        if (!hasTransform)
+        {
+            components.emplace(components.begin(), transformType, Arena::makeShared<Transform>());
+        }
+
+        applyChanges(ComponentMask(), components);
+    }
+
+    Entity::~Entity()
+    {
+        ArchetypeStorage::getInstance().removeEntity(*this);
+        releaseId();
+    }
+
+    void Entity::acquireId()
+    {
+        if (!s_freeSlots.empty())
+        {
+            m_id.index = s_freeSlots.back();
+            s_freeSlots.pop_back();
+        }
+        else
+        {
+            m_id.index = static_cast<std::uint32_t>(s_slots.size());
+            s_slots.emplace_back();
+        }
+
+        m_id.generation = s_slots[m_id.index].generation;
+        s_slots[m_id.index].entity = this;
+    }
+
+    void Entity::releaseId()
+    {
+        if (m_id.isNull())
+        {
+            return;
+        }
+
+        EntitySlot &slot = s_slots[m_id.index];
+        slot.entity = nullptr;
+        slot.generation++;
+        slot.tags = 0;
+        slot.layer = 0;
+        s_freeSlots.push_back(m_id.index);
+        m_id = EntityId{};
+    }
+
+    namespace
+    {
+        // Lets allocate_shared reach the protected constructors, so the entity and its control block share one allocation
+        struct SharedEntity : Entity
+        {
+            template <typename... Args>
+            SharedEntity(Args &&...args) : Entity(std::forward<Args>(args)...) {}
+        };
     }
 
     std::shared_ptr<Entity> Entity::createEntity(sf::Vector3f initialPos)
     {
-        return std::make_shared<Entity>(Entity(initialPos));
+        // Constructed in place, the archetype storage keeps a pointer to the entity
+        return Arena::makeShared<SharedEntity>(initialPos);
     }
 
     std::shared_ptr<Entity> Entity::createEntity(std::string name, sf::Vector3f initialPos)
     {
-        return std::make_shared<Entity>(Entity(initialPos, name));
+        return Arena::makeShared<SharedEntity>(initialPos, std::move(name));
     }
 
     void Entity::addComponent(std::shared_ptr<Component> component)
     {
-        if (getComponent(component->getName()))
+        if (!component)
             return;
 
-        m_components.push_back(component);
-        component->attach(std::shared_ptr<Entity>(this));
-        component->start();
+        // Resolved before the call, the argument moving the pointer may be evaluated first
+        ComponentTypeId type = ComponentTypes::getOrAssign(typeid(*component));
+        addComponent(type, std::move(component));
+    }
+
+    void Entity::addComponent(ComponentTypeId type, std::shared_ptr<Component> component)
+    {
+        if (m_componentMask.test(type))
+            return;
+
+        Component *added = component.get();
+        Registry::getInstance().nameType(type, *added);
+        if (!ArchetypeStorage::getInstance().addComponent(*this, type, std::move(component)))
+            return;
+
+        if (!transform && type == ComponentTypes::get<Transform>())
+        {
+            transform = static_cast<Transform *>(added);
+        }
+
+        added->attach(*this, type);
+        added->start();
+    }
+
+    void Entity::applyChanges(const ComponentMask &removed, ComponentList &added)
+    {
+        std::vector<std::pair<ComponentTypeId, Component *>> attached;
+        attached.reserve(added.size());
+        for (auto &[type, component] : added)
+        {
+            attached.emplace_back(type, component.get());
+            Registry::getInstance().nameType(type, *component);
+        }
+
+        ArchetypeStorage::getInstance().applyChanges(*this, removed, added);
+
+        // Transform first, the other components copy the pointer when they attach
+        const ComponentTypeId transformType = ComponentTypes::get<Transform>();
+        for (auto &[type, component] : attached)
+        {
+            if (!transform && type == transformType)
+            {
+                transform = static_cast<Transform *>(component);
+            }
+        }
+
+        for (auto &[type, component] : attached)
+        {
+            component->attach(*this, type);
+            component->start();
+        }
     }
 
     std::shared_ptr<wpwp::Component> Entity::getComponent(const std::string &componentName) const
     {
-        for (auto &comp : m_components)
+        if (!m_archetype)
+        {
+            return {};
+        }
+
+        // A name nobody interned can't be on any entity
+        const Registry &registry = Registry::getInstance();
+        Registry::Symbol symbol = registry.findSymbol(componentName);
+        if (symbol == Registry::NO_SYMBOL)
         {
-            if (comp->getName() == componentName)
+            return {};
+        }
+
+        const auto &types = m_archetype->getTypes();
+        for (std::size_t i = 0; i < types.size(); i++)
+        {
+            if (registry.getTypeName(types[i]) == symbol)
             {
-                return comp;
+                return m_archetype->getColumn(i)[m_row];
             }
         }
         return {}; // Default-constructed shared_ptr
@@ -73,13 +206,15 @@ namespace wpwp
             return;
         }
 
-        auto it = std::find_if(m_components.begin(), m_components.end(),
-                               [&](auto c)
-                               { return c->getName() == comp->getName(); });
+        ComponentTypeId type = ComponentTypes::getOrAssign(typeid(*comp));
+        if (!isRemovable(type))
+        {
+            return;
+        }
 
-        if (it != m_components.end())
+        if (m_componentMask.test(type))
         {
-            m_components.erase(it);
+            ArchetypeStorage::getInstance().removeComponent(*this, type);
             LOG("Component removed successfully.");
         }
         else
@@ -88,17 +223,58 @@ namespace wpwp
         }
     }
 
+    bool Entity::isRemovable(ComponentTypeId type)
+    {
+        if (type == ComponentTypes::get<Transform>())
+        {
+            ERROR("The transform can't be removed from an entity, destroy the entity instead");
+            return false;
+        }
+        return true;
+    }
+
     void Entity::clearComponents()
     {
-        m_components.clear();
+        ArchetypeStorage::getInstance().removeEntity(*this);
+        transform = nullptr;
     }
 
     void Entity::destroy(std::shared_ptr<Entity> e)
     {
-        onEntityDestroyed.invoke(e);
+        // Already destroyed, and maybe waiting in the recycling pool with its components
+        if (e->m_id.isNull())
+        {
+            return;
+        }
 
-        // Remove from the entities vector
-        s_entities.erase(std::remove(s_entities.begin(), s_entities.end(), e), s_entities.end());
+        // Children outlive their parent as roots, where they are in the world now
+        if (e->transform)
+        {
+            std::vector<EntityId> children = e->transform->getChildren();
+            for (EntityId child : children)
+            {
+                e->transform->removeChild(child);
+            }
+            e->transform->setParent(EntityId());
+        }
+
+        bool wasInstantiated = e->m_instantiated;
+        if (wasInstantiated)
+        {
+            e->unregisterInstance();
+            s_pendingEvents.destroyed.push_back(e->m_id);
+        }
+
+        // Only instantiated entities go back to the pool, the others would keep their components with nothing to reuse them
+        if (!e->m_recyclable || !wasInstantiated)
+        {
+            e->clearComponents();
+        }
+        else
+        {
+            recycle(e);
+        }
+        e->releaseId();
 
         // Remove from the name to entity map
         auto it = s_nameToEntity.find(e->m_name);
@@ -113,34 +289,197 @@ namespace wpwp
         }
     }
 
-    void Entity::start()
+    void Entity::destroyAll()
     {
-    }
+        // Listeners forget every entity at once, the batched events would only name entities they no longer know
+        s_pendingEvents.created.clear();
+        s_pendingEvents.destroyed.clear();
+        onAllEntitiesDestroyed.invoke();
 
-    void Entity::update(float deltaTime)
-    {
-        for (auto &comp : m_components)
+        std::vector<std::shared_ptr<Entity>> entities;
+        entities.swap(s_entities);
+        s_nameToEntity.clear();
+        s_nameCount.clear();
+
+        // The whole hierarchy goes away together, so nobody is reparented
+        for (auto &e : entities)
+        {
+            e->m_instantiated = false;
+            e->clearComponents();
+            e->releaseId();
+        }
+
+        // Entities created but never instantiated are only in the entity table, they are emptied the same way
+        for (std::size_t i = 0; i < s_slots.size(); i++)
         {
-            if (!comp)
+            if (Entity *e = s_slots[i].entity)
             {
-                ERROR("NON VALID COMP");
-                return;
+                e->clearComponents();
+                e->releaseId();
             }
-            if (!comp->transform)
+        }
+
+        clearRecycled();
+    }
+
+    void Entity::flushLifecycleEvents()
+    {
+        // Swapped out first, so listeners creating or destroying entities add to the next batch
+        std::swap(s_pendingEvents, s_flushingEvents);
+
+        if (!s_flushingEvents.created.empty())
+        {
+            onEntitiesCreated.invoke(s_flushingEvents.created);
+        }
+
+        if (!s_flushingEvents.destroyed.empty())
+        {
+            onEntitiesDestroyed.invoke(s_flushingEvents.destroyed);
+        }
+
+        s_flushingEvents.created.clear();
+        s_flushingEvents.destroyed.clear();
+    }
+
+    void Entity::clearRecycled()
+    {
+        for (auto &[shape, entities] : s_recycled)
+        {
+            for (auto &e : entities)
             {
-                comp.get()->attach(std::shared_ptr<Entity>(this));
+                e->clearComponents();
             }
-            comp.get()->update();
         }
+        s_recycled.clear();
+    }
+
+    void Entity::unregisterInstance()
+    {
+        m_instantiated = false;
+        if (m_instanceIndex >= s_entities.size() || s_entities[m_instanceIndex].get() != this)
+        {
+            return;
+        }
+
+        // Swapped with the last entity instead of shifting everything after it
+        if (m_instanceIndex != s_entities.size() - 1)
+        {
+            s_entities[m_instanceIndex] = std::move(s_entities.back());
+            s_entities[m_instanceIndex]->m_instanceIndex = m_instanceIndex;
+        }
+        s_entities.pop_back();
+    }
+
+    void Entity::recycle(const std::shared_ptr<Entity> &e)
+    {
+        if (!e->m_archetype)
+        {
+            return;
+        }
+
+        for (Component &component : e->getComponents())
+        {
+            component.onDisable();
+        }
+        s_recycled[e->m_componentMask].push_back(e);
     }
+
+    void Entity::revive(std::string name)
+    {
+        acquireId();
+        m_name = std::move(name);
+        m_enabled = true;
+        m_activeInHierarchy = true;
+
+        for (Component &component : getComponents())
+        {
+            component.attach(*this, component.getTypeId());
+        }
+    }
+
+    void Entity::start()
+    {
+    }
+
     void Entity::instantiate(std::shared_ptr<Entity> e)
     {
-        for (auto &c : e->m_components)
+        registerInstance(e);
+    }
+
+    void Entity::instantiate(const std::vector<std::shared_ptr<Entity>> &entities)
+    {
+        s_entities.reserve(s_entities.size() + entities.size());
+        for (auto &e : entities)
+        {
+            registerInstance(e);
+        }
+    }
+
+    std::vector<std::shared_ptr<Entity>> Entity::instantiate(const Prefab &prefab, std::size_t count, const std::vector<sf::Vector3f> &positions)
+    {
+        std::vector<std::shared_ptr<Entity>> entities;
+        if (!prefab.isValid())
+        {
+            ERROR("Can't instantiate an empty prefab");
+            return entities;
+        }
+
+        entities.reserve(count);
+
+        // Copies always get a transform, so recycled ones are kept under the prefab's types plus it
+        std::vector<std::shared_ptr<Entity>> *recycled = nullptr;
+        if (prefab.isRecycling())
         {
-            // c->attach(e);
-            // c->start();
+            ComponentMask shape = prefab.getComponentMask();
+            shape.set(ComponentTypes::get<Transform>());
+            auto it = s_recycled.find(shape);
+            if (it != s_recycled.end())
+            {
+                recycled = &it->second;
+            }
         }
 
+        const std::size_t reused = recycled ? std::min(count, recycled->size()) : 0;
+        ArchetypeStorage::getInstance().reserve(prefab.getComponentMask(), count - reused);
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            std::shared_ptr<Entity> e;
+            if (i < reused)
+            {
+                e = std::move(recycled->back());
+                recycled->pop_back();
+                e->revive(prefab.getName());
+            }
+            else
+            {
+                e = Arena::makeShared<SharedEntity>(prefab.getName(), prefab.createComponents());
+            }
+
+            e->m_recyclable = prefab.isRecycling();
+            prefab.applyTo(*e);
+
+            if (i < positions.size())
+            {
+                e->transform->setPosition(positions[i]);
+            }
+
+            if (i < reused)
+            {
+                for (Component &component : e->getComponents())
+                {
+                    component.onEnable();
+                }
+            }
+            entities.push_back(std::move(e));
+        }
+
+        instantiate(entities);
+        return entities;
+    }
+
+    void Entity::registerInstance(const std::shared_ptr<Entity> &e)
+    {
         if (e->m_name == DEFAULT_ENTITY_NAME)
         {
             e->m_name = Util::generate_uuid_v4();
@@ -157,11 +496,13 @@ namespace wpwp
             s_nameCount[e->m_name] = 0;
         }
 
+        e->m_instantiated = true;
+        e->m_instanceIndex = s_entities.size();
         s_entities.push_back(e);
-        onEntityInstantiated.invoke(e);
+        s_pendingEvents.created.push_back(e->m_id);
     }
 
-    std::vector<std::shared_ptr<Entity>> Entity::getAllEntities()
+    const std::vector<std::shared_ptr<Entity>> &Entity::getAllEntities()
     {
         return Entity::s_entities;
     }
@@ -179,6 +520,26 @@ namespace wpwp
     void Entity::setEnabled(bool enabled)
     {
         this->m_enabled = enabled;
+        refreshActiveInHierarchy();
+    }
+
+    void Entity::refreshActiveInHierarchy()
+    {
+        Entity *parent = transform ? Entity::get(transform->getParent()) : nullptr;
+        bool active = m_enabled && (!parent || parent->m_activeInHierarchy);
+        if (active == m_activeInHierarchy)
+        {
+            return;
+        }
+
+        m_activeInHierarchy = active;
+        for (EntityId childId : transform->getChildren())
+        {
+            if (Entity *child = Entity::get(childId))
+            {
+                child->refreshActiveInHierarchy();
+            }
+        }
     }
 
     bool Entity::getEnabled() const
@@ -186,6 +547,28 @@ namespace wpwp
         return this->m_enabled;
     }
 
+    void Entity::setTags(TagMask tags)
+    {
+        if (!m_id.isNull())
+        {
+            s_slots[m_id.index].tags = tags;
+        }
+    }
+
+    void Entity::setLayer(Layer layer)
+    {
+        if (layer >= MAX_LAYERS)
+        {
+            ERROR("Layer ", int(layer), " is out of range, there are ", MAX_LAYERS, " layers");
+            return;
+        }
+
+        if (!m_id.isNull())
+        {
+            s_slots[m_id.index].layer = layer;
+        }
+    }
+
     void Entity::setName(std::string newName)
     {
         // TODO: update in arrays
@@ -197,9 +580,4 @@ namespace wpwp
         setName(std::string(newName));
     }
 
-    std::vector<std::shared_ptr<Component>> Entity::getComponents() const
-    {
-        return m_components;
-    }
-
 }
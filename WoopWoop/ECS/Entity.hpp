@@ -2,10 +2,14 @@
 #define ENTITY_HPP
 
 #include <SFML/System/Vector3.hpp>
+#include <span>
 #include <vector>
 #include <memory>
 #include <unordered_map>
 #include "Component.hpp"
+#include "Archetype.hpp"
+#include "EntityId.hpp"
+#include "Tags.hpp"
 #include "Util/Signal.hpp"
 #include "Util/Util.hpp"
 #define DEFAULT_ENTITY_NAME "__woopwoop_generatename"
@@ -13,6 +17,7 @@
 namespace wpwp
 {
     struct Transform;
+    class Prefab;
     namespace Editor
     {
         class Editor;
@@ -40,7 +45,21 @@ namespace wpwp
          */
         Entity(sf::Vector3f initialPos, std::string name);
 
+        /**
+         * @brief Constructs an entity with a set of components, moved into their archetype at once.
+         * A Transform is created if the set doesn't have one.
+         *
+         * @param name The name of the entity.
+         * @param components The components of the entity.
+         */
+        Entity(std::string name, ComponentList components);
+
+        Entity(const Entity &) = delete;
+        Entity &operator=(const Entity &) = delete;
+
     public:
+        ~Entity();
+
         /**
          * @brief Creates and returns an entity with the specified initial position.
          *
@@ -65,13 +84,6 @@ namespace wpwp
          */
         void start();
 
-        /**
-         * @brief Updates the entity.
-         *
-         * @param deltaTime The time elapsed since the last update.
-         */
-        void update(float deltaTime);
-
         /**
          * @brief Enables or disables the entity.
          *
@@ -86,6 +98,13 @@ namespace wpwp
          */
         bool getEnabled() const;
 
+        /**
+         * @brief Checks if the entity and all of its ancestors are enabled, read from a cached flag.
+         *
+         * @return True if the entity is active in the hierarchy.
+         */
+        bool isActiveInHierarchy() const { return m_activeInHierarchy; }
+
         /**
          * @brief Gets the name of the entity.
          *
@@ -93,16 +112,70 @@ namespace wpwp
          */
         std::string getName() const { return m_name; };
 
+        /**
+         * @brief Gets the generational id of the entity.
+         *
+         * @return The id of the entity, or a null id once the entity was destroyed.
+         */
+        EntityId getId() const { return m_id; }
+
+        /**
+         * @brief Checks if the entity was instantiated into the scene.
+         *
+         * @return True if the entity was instantiated and not destroyed since.
+         */
+        bool isInstantiated() const { return m_instantiated; }
+
+        /**
+         * @brief Gets the tags of the entity, stored in the entity table next to the other entities' tags.
+         *
+         * @return The tag mask, 0 once the entity was destroyed.
+         */
+        TagMask getTags() const { return getTags(m_id); }
+
+        /**
+         * @brief Replaces the tags of the entity.
+         *
+         * @param tags The new tag mask, see Tags::get().
+         */
+        void setTags(TagMask tags);
+
+        void addTags(TagMask tags) { setTags(getTags() | tags); }
+        void removeTags(TagMask tags) { setTags(getTags() & ~tags); }
+
+        /**
+         * @brief Checks if the entity has every tag of a mask.
+         *
+         * @param tags The tags to check for.
+         * @return True if all of them are set.
+         */
+        bool hasTags(TagMask tags) const { return (getTags() & tags) == tags; }
+
+        /**
+         * @brief Gets the render and physics layer of the entity.
+         *
+         * @return The layer, 0 by default.
+         */
+        Layer getLayer() const { return getLayer(m_id); }
+
+        /**
+         * @brief Sets the render and physics layer of the entity.
+         *
+         * @param layer The layer, below MAX_LAYERS.
+         */
+        void setLayer(Layer layer);
+
         void setName(std::string newName);
 
         void setName(const char *newName);
 
         /**
          * @brief Gets all components attached to the entity.
+         * The range reads the entity's archetype row directly, it's invalidated when components are added or removed.
          *
-         * @return A vector containing pointers to all components.
+         * @return A range of references to all components.
          */
-        std::vector<std::shared_ptr<Component>> getComponents() const;
+        ComponentRange getComponents() const { return ComponentRange(m_archetype, m_row); }
 
         /**
          * @brief Adds a new component of type T to the entity.
@@ -110,20 +183,17 @@ namespace wpwp
          * @tparam T The type of component to add.
          * @tparam Args Types of arguments to forward to the T's constructor.
          * @param args Arguments to forward to the T's constructor.
-         * @return A shared pointer to the added component.
+         * @return A pointer to the added component, owned by the entity.
          */
         template <typename T, typename... Args>
-        std::shared_ptr<T> addComponent(Args &&...args)
+        T *addComponent(Args &&...args)
         {
             static_assert(std::is_base_of<Component, T>::value, "T must inherit from Component");
 
-            auto newComponent = std::make_shared<T>(std::forward<Args>(args)...);
-
-            // newComponent.get()->attach(std::shared_ptr<Entity>(this));
-
-            auto componentPtr = std::dynamic_pointer_cast<T>(newComponent);
-            addComponent(componentPtr);
-            return newComponent;
+            auto newComponent = Arena::makeShared<T>(std::forward<Args>(args)...);
+            T *component = newComponent.get();
+            addComponent(ComponentTypes::get<T>(), std::move(newComponent));
+            return component;
         }
 
         /**
@@ -135,47 +205,82 @@ namespace wpwp
 
         /**
          * @brief Gets a component of a specified type attached to the entity.
+         * Constant time, exact types are a mask test and a column lookup, base types (e.g. Renderer) use a cached relation.
          *
          * @tparam T The type of component to retrieve.
          * @return A pointer to the component of the specified type, or nullptr if not found.
          */
         template <typename T>
-        std::shared_ptr<T> getComponent() const
+        T *getComponent() const
         {
-            for (auto &c : m_components)
+            static_assert(std::is_base_of<Component, T>::value, "T must inherit from Component");
+
+            if (!m_archetype)
             {
-                auto casted = std::dynamic_pointer_cast<T>(c);
-                if (casted)
-                {
-                    return casted;
-                }
+                return nullptr;
             }
-            return nullptr;
+
+            const ComponentTypeId type = ComponentTypes::get<T>();
+            if (m_componentMask.test(type))
+            {
+                return static_cast<T *>(m_archetype->getComponent(type, m_row));
+            }
+
+            return static_cast<T *>(ComponentTypes::findDerived<T>(m_componentMask, [&](ComponentTypeId stored)
+                                                                   { return m_archetype->getComponent(stored, m_row); }));
+        }
+
+        /**
+         * @brief Checks if the entity has a component of a specified type.
+         *
+         * @tparam T The type of component to check for.
+         * @return True if a component of type T (or derived from T) is attached.
+         */
+        template <typename T>
+        bool hasComponent() const
+        {
+            return getComponent<T>() != nullptr;
         }
 
+        /**
+         * @brief Gets the set of component types attached to the entity.
+         *
+         * @return The component type mask of the entity.
+         */
+        const ComponentMask &getComponentMask() const { return m_componentMask; }
+
         /**
          * @brief Gets a component of a specified type attached to the entity using the registry.
+         * The name is looked up among the interned names once, then matched against the interned names of the entity's component types.
          *
          * @param componentName The name of the component type.
          * @return A pointer to the component of the specified type, or nullptr if not found.
          */
         std::shared_ptr<Component> getComponent(const std::string &componentName) const;
 
+        /**
+         * @brief Gets the component with the given type id, the type is matched exactly.
+         *
+         * @param type The type id of the component.
+         * @return A pointer to the component, or nullptr if not found.
+         */
+        Component *getComponent(ComponentTypeId type) const { return m_componentMask.test(type) ? m_archetype->getComponent(type, m_row) : nullptr; }
+
         /**
          * @brief Gets or adds a component of a specified type attached to the entity.
          *
          * @tparam T The type of component to retrieve or add.
-         * @return A shared pointer to the component.
+         * @return A pointer to the component.
          */
         template <class T>
-        std::shared_ptr<T> getOrAddComponent()
+        T *getOrAddComponent()
         {
-            if (!getComponent<T>())
+            if (T *component = getComponent<T>())
             {
-                return addComponent<T>();
+                return component;
             }
 
-            return std::dynamic_pointer_cast<T>(getComponent<T>());
+            return addComponent<T>();
         }
 
         /**
@@ -186,26 +291,20 @@ namespace wpwp
         template <typename T>
         void removeComponent()
         {
-            for (auto it = m_components.begin(); it != m_components.end(); ++it)
+            if (T *component = getComponent<T>())
             {
-                auto casted = std::dynamic_pointer_cast<T>(*it);
-                if (casted)
+                const ComponentTypeId type = ComponentTypes::getOrAssign(typeid(*component));
+                if (!isRemovable(type))
                 {
-                    m_components.erase(it);
-                    LOG("Component of type ", typeid(T).name(), " removed successfully.");
                     return;
                 }
+                ArchetypeStorage::getInstance().removeComponent(*this, type);
+                LOG("Component of type ", typeid(T).name(), " removed successfully.");
+                return;
             }
             ERROR("Component of type ", typeid(T).name(), " not found in the entity's component list.");
         }
 
-        template <class T>
-        static std::vector<std::shared_ptr<Entity>> getEntitiesWithComponent()
-        {
-            return VectorUtil::filter(s_entities, [&](std::shared_ptr<Entity> e)
-                                      { return (e->getComponent<T>() != nullptr); });
-        }
-
         void removeComponent(std::shared_ptr<Component> comp);
 
         /**
@@ -214,22 +313,50 @@ namespace wpwp
         void clearComponents();
 
         /**
-         * @brief Signal emitted when an entity is instantiated.
+         * @brief Signal emitted by destroyAll(), which drops the pending batches instead of reporting every entity.
+         */
+        static Signal<> onAllEntitiesDestroyed;
+
+        /**
+         * @brief Signal emitted once per sync point with the ids of every entity instantiated since the last one.
+         * Instantiating and destroying entities emit nothing right away, listeners learn about them in these batches.
          */
-        static Signal<std::shared_ptr<Entity>> onEntityInstantiated;
+        static Signal<std::span<const EntityId>> onEntitiesCreated;
 
         /**
-         * @brief Signal emitted when an entity is destroyed.
+         * @brief Signal emitted once per sync point with the ids of every entity destroyed since the last one, after onEntitiesCreated.
+         * The ids are already stale, they can only be used to drop what a listener keeps per entity.
          */
-        static Signal<std::shared_ptr<Entity>> onEntityDestroyed;
+        static Signal<std::span<const EntityId>> onEntitiesDestroyed;
 
         /**
-         * @brief Destroys the specified entity.
+         * @brief Emits onEntitiesCreated and onEntitiesDestroyed for the entities batched since the last call.
+         * Called by the engine once per frame, after the command buffer is applied.
+         * Entities created or destroyed by the listeners are reported by the next call.
+         */
+        static void flushLifecycleEvents();
+
+        /**
+         * @brief Destroys the specified entity in constant time.
+         * Entities spawned from a recycling prefab are deactivated and kept with their components for the next spawn instead.
+         * Destroying an entity that was already destroyed does nothing.
          *
          * @param e Pointer to the entity to destroy.
          */
         static void destroy(std::shared_ptr<Entity>);
 
+        /**
+         * @brief Destroys every entity at once, without detaching them from each other first.
+         * Entities created but never instantiated lose their components too.
+         * Entities that are still referenced elsewhere stay alive, but without components.
+         */
+        static void destroyAll();
+
+        /**
+         * @brief Frees the entities kept by recycling prefabs, e.g. after a burst of spawns.
+         */
+        static void clearRecycled();
+
         /**
          * @brief Instantiates the specified entity.
          *
@@ -238,11 +365,31 @@ namespace wpwp
         static void instantiate(std::shared_ptr<Entity>);
 
         /**
-         * @brief Gets all instantiated entities.
+         * @brief Instantiates a batch of entities, reserving the storage for all of them at once.
+         *
+         * @param entities The entities to instantiate.
+         */
+        static void instantiate(const std::vector<std::shared_ptr<Entity>> &entities);
+
+        /**
+         * @brief Creates and instantiates copies of a prefab in bulk.
+         * Storage is reserved upfront and every copy moves into its archetype once.
+         * If the prefab is recycling, recycled entities of the same component types are reused first.
+         *
+         * @param prefab The prefab to copy.
+         * @param count The amount of copies.
+         * @param positions Position of each copy, copies past the end of it keep the prefab's position.
+         * @return The created entities.
+         */
+        static std::vector<std::shared_ptr<Entity>> instantiate(const Prefab &prefab, std::size_t count, const std::vector<sf::Vector3f> &positions = {});
+
+        /**
+         * @brief Gets all instantiated entities, in no particular order.
+         * Don't instantiate or destroy entities while iterating it, record them in a CommandBuffer instead.
          *
          * @return A vector containing pointers to all instantiated entities.
          */
-        static std::vector<std::shared_ptr<Entity>> getAllEntities();
+        static const std::vector<std::shared_ptr<Entity>> &getAllEntities();
 
         /**
          * @brief Gets the entity with the specified name.
@@ -252,21 +399,151 @@ namespace wpwp
          */
         static std::shared_ptr<Entity> getEntityWithName(std::string name);
 
-        std::shared_ptr<Transform> transform; // Pointer to the transform component of the entity.
+        /**
+         * @brief Gets the entity with the specified id in constant time.
+         *
+         * @param id The id of the entity to retrieve.
+         * @return Pointer to the entity, or nullptr if the id is stale or null.
+         */
+        static Entity *get(EntityId id)
+        {
+            if (id.index < s_slots.size() && s_slots[id.index].generation == id.generation)
+            {
+                return s_slots[id.index].entity;
+            }
+            return nullptr;
+        }
+
+        /**
+         * @brief Checks if an id still refers to a live entity.
+         *
+         * @param id The id to check.
+         * @return True if the id resolves to an entity.
+         */
+        static bool isValid(EntityId id) { return get(id) != nullptr; }
+
+        /**
+         * @brief Gets the tags of an entity straight from the entity table.
+         *
+         * @param id The id of the entity.
+         * @return The tag mask, 0 if the id is stale or null.
+         */
+        static TagMask getTags(EntityId id) { return get(id) ? s_slots[id.index].tags : 0; }
+
+        /**
+         * @brief Gets the layer of an entity straight from the entity table.
+         *
+         * @param id The id of the entity.
+         * @return The layer, 0 if the id is stale or null.
+         */
+        static Layer getLayer(EntityId id) { return get(id) ? s_slots[id.index].layer : 0; }
+
+        Transform *transform = nullptr; // Pointer to the transform component of the entity.
 
     protected:
-        std::string m_name; // Name of the entity.
+        /**
+         * @brief Adds a component whose type id is already known.
+         */
+        void addComponent(ComponentTypeId type, std::shared_ptr<Component> component);
+
+        /**
+         * @brief Ids batched for the lifecycle signals.
+         */
+        struct LifecycleBatch
+        {
+            std::vector<EntityId> created;   // Ids of the entities instantiated.
+            std::vector<EntityId> destroyed; // Ids of the entities destroyed, no longer valid.
+        };
+
+        /**
+         * @brief Entry of the entity table, indexed by EntityId::index.
+         */
+        struct EntitySlot
+        {
+            Entity *entity = nullptr;     // Entity currently occupying the slot.
+            std::uint32_t generation = 0; // Bumped every time the slot is freed.
+            TagMask tags = 0;             // Tags of the entity, kept here so filters read one contiguous table.
+            Layer layer = 0;              // Render and physics layer of the entity.
+        };
+
+        /**
+         * @brief Adds and removes several components with a single archetype move, then attaches and starts the added ones.
+         */
+        void applyChanges(const ComponentMask &removed, ComponentList &added);
+
+        /**
+         * @brief Checks that a component type may be removed, logging an error for the transform.
+         * Entity::transform and every component's transform point at the transform, so it lives as long as the entity.
+         */
+        static bool isRemovable(ComponentTypeId type);
+
+        /**
+         * @brief Adds the entity to the instantiated ones and the name map, and batches its creation event.
+         */
+        static void registerInstance(const std::shared_ptr<Entity> &e);
 
-        static std::vector<std::shared_ptr<Entity>> s_entities;                         // Vector containing pointers to all instantiated entities.
-        static std::unordered_map<std::string, std::shared_ptr<Entity>> s_nameToEntity; // Map storing names and corresponding entities.
-        static std::unordered_map<std::string, int> s_nameCount;                        // Map storing the count of entities with the same name.
+        /**
+         * @brief Removes the entity from s_entities by moving the last entity into its place.
+         */
+        void unregisterInstance();
+
+        /**
+         * @brief Deactivates the components of a destroyed recyclable entity and keeps it for the next spawn of its shape.
+         */
+        static void recycle(const std::shared_ptr<Entity> &e);
 
-        std::vector<std::shared_ptr<Component>> m_components; // Vector containing pointers to all components attached to the entity.
-        bool m_enabled = true;                                // Flag indicating whether the entity is enabled.
+        /**
+         * @brief Gives a recycled entity a new id and name, and reattaches its components to it.
+         */
+        void revive(std::string name);
+
+        /**
+         * @brief Recomputes the cached active flag from the parent, and the children's if it changed.
+         */
+        void refreshActiveInHierarchy();
+
+        /**
+         * @brief Takes a free slot in the entity table and assigns its id to the entity.
+         */
+        void acquireId();
+
+        /**
+         * @brief Frees the entity's slot, invalidating every handle to it.
+         */
+        void releaseId();
+
+        EntityId m_id;                    // Generational id of the entity.
+        std::string m_name;               // Name of the entity.
+        bool m_instantiated = false;      // Flag indicating whether the entity was instantiated.
+        Archetype *m_archetype = nullptr; // Archetype holding the entity's components.
+        std::size_t m_row = 0;            // Row of the entity inside its archetype.
+        ComponentMask m_componentMask;    // Types of the components attached to the entity.
+        std::size_t m_instanceIndex = 0;  // Index of the entity in s_entities while instantiated.
+        bool m_recyclable = false;        // Flag indicating whether destroying the entity recycles it.
+
+        static std::vector<std::shared_ptr<Entity>> s_entities;                                    // Vector containing pointers to all instantiated entities.
+        static std::unordered_map<std::string, std::shared_ptr<Entity>> s_nameToEntity;            // Map storing names and corresponding entities.
+        static std::unordered_map<std::string, int> s_nameCount;                                   // Map storing the count of entities with the same name.
+        static std::vector<EntitySlot> s_slots;                                                    // Entity table, indexed by id.
+        static std::vector<std::uint32_t> s_freeSlots;                                             // Indices of the free slots in the entity table.
+        static std::unordered_map<ComponentMask, std::vector<std::shared_ptr<Entity>>> s_recycled; // Destroyed recyclable entities, by component types.
+        static LifecycleBatch s_pendingEvents;                                                     // Lifecycle events not emitted yet.
+        static LifecycleBatch s_flushingEvents;                                                    // Lifecycle events being emitted, kept to reuse its storage.
+
+        bool m_enabled = true;           // Flag indicating whether the entity is enabled.
+        bool m_activeInHierarchy = true; // Flag indicating whether the entity and all of its ancestors are enabled.
 
         friend Editor::Editor;
+        friend class ArchetypeStorage;
+        friend class CommandBuffer;
+        friend class Transform;
     };
 
+    inline Entity *EntityHandle::get() const
+    {
+        return Entity::get(m_id);
+    }
+
 } // namespace wpwp
 
 #endif // ENTITY_HPP
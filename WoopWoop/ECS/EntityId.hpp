@@ -0,0 +1,79 @@
+#ifndef ENTITY_ID_HPP
+#define ENTITY_ID_HPP
+
+#include <cstdint>
+#include <functional>
+
+namespace wpwp
+{
+    class Entity;
+
+    /**
+     * @brief Compact generational handle to an entity.
+     *
+     * The index points at a slot in the entity table, the generation is bumped every time the slot is freed,
+     * so a handle to a destroyed entity never resolves to whatever entity reuses its slot.
+     */
+    struct EntityId
+    {
+        static constexpr std::uint32_t INVALID_INDEX = ~std::uint32_t(0);
+
+        std::uint32_t index = INVALID_INDEX; // Slot of the entity in the entity table.
+        std::uint32_t generation = 0;        // Generation of the slot when the handle was created.
+
+        /**
+         * @brief Checks if the handle was never assigned to an entity.
+         *
+         * @return True if the handle is null.
+         */
+        bool isNull() const { return index == INVALID_INDEX; }
+
+        /**
+         * @brief Packs the handle into a single 64 bit value.
+         *
+         * @return The packed handle.
+         */
+        std::uint64_t toU64() const { return (std::uint64_t(generation) << 32) | index; }
+
+        bool operator==(const EntityId &other) const = default;
+    };
+
+    /**
+     * @brief Lightweight reference to an entity through its id, resolved in O(1) on every access.
+     * Lets components write `entity->...` without holding the entity alive.
+     */
+    struct EntityHandle
+    {
+        EntityHandle() = default;
+        EntityHandle(EntityId id) : m_id(id) {}
+
+        /**
+         * @brief Gets the entity the handle points to.
+         *
+         * @return Pointer to the entity, or nullptr if it no longer exists.
+         */
+        Entity *get() const;
+
+        EntityId getId() const { return m_id; }
+
+        Entity *operator->() const { return get(); }
+        explicit operator bool() const { return get() != nullptr; }
+
+    private:
+        EntityId m_id;
+    };
+} // namespace wpwp
+
+namespace std
+{
+    template <>
+    struct hash<wpwp::EntityId>
+    {
+        std::size_t operator()(const wpwp::EntityId &id) const noexcept
+        {
+            return std::hash<std::uint64_t>()(id.toU64());
+        }
+    };
+}
+
+#endif // ENTITY_ID_HPP
@@ -0,0 +1,174 @@
+#include "Prefab.hpp"
+#include "Entity.hpp"
+#include "Serlization/SceneSerializer.hpp"
+
+namespace wpwp
+{
+    Prefab::Prefab(const Entity &entity)
+    {
+        setData(SceneSerializer::serializeEntity(entity));
+    }
+
+    bool Prefab::loadFromScene(const std::filesystem::path &scene, const std::string &entityName)
+    {
+        std::filesystem::path path = SceneSerializer::generatePath(scene);
+
+        std::ifstream stream(path);
+        if (!stream)
+        {
+            ERROR("Couldn't open scene file: ", path);
+            return false;
+        }
+
+        std::stringstream strStream;
+        strStream << stream.rdbuf();
+
+        YAML::Node data = YAML::Load(strStream.str());
+        for (auto entity : data["Entities"])
+        {
+            if (entity["Entity"] && entity["Entity"].as<std::string>() == entityName)
+            {
+                setData(entity);
+                return true;
+            }
+        }
+
+        ERROR("No entity named ", entityName, " in scene ", path);
+        return false;
+    }
+
+    namespace
+    {
+        FieldValue readValue(const YAML::Node &node, FieldType type)
+        {
+            switch (type)
+            {
+            case FieldType::Bool:
+                return node.as<bool>();
+            case FieldType::Int:
+                return node.as<int>();
+            case FieldType::Float:
+                return node.as<float>();
+            case FieldType::String:
+                return node.as<std::string>();
+            case FieldType::Vector2f:
+                return node.as<sf::Vector2f>();
+            case FieldType::Vector3f:
+                return node.as<sf::Vector3f>();
+            case FieldType::Color:
+                return node.as<sf::Color>();
+            }
+            return FieldValue();
+        }
+    }
+
+    void Prefab::setData(const YAML::Node &data)
+    {
+        m_name = data["Entity"].as<std::string>();
+        m_valid = true;
+        m_types.clear();
+        m_mask = ComponentMask();
+        m_values.clear();
+        m_rendererColor.reset();
+
+        m_tags = 0;
+        if (auto tagNames = data["Tags"])
+        {
+            for (std::size_t i = 0; i < tagNames.size(); i++)
+            {
+                m_tags |= Tags::get(tagNames[i].as<std::string>());
+            }
+        }
+        m_layer = data["Layer"] ? static_cast<Layer>(data["Layer"].as<int>()) : 0;
+
+        // Types and values are resolved once here, so spawning a copy never looks anything up by name or parses YAML
+        for (auto it = data.begin(); it != data.end(); ++it)
+        {
+            const Registry::TypeMetadata *metadata = Registry::getInstance().getMetadata(it->first.as<std::string>());
+            if (!metadata || m_mask.test(metadata->id))
+            {
+                continue;
+            }
+
+            m_mask.set(metadata->id);
+            m_types.emplace_back(metadata->id, metadata->factory);
+
+            const YAML::Node componentData = it->second;
+            for (const FieldDescriptor &field : metadata->fields)
+            {
+                if (field.group && !componentData[field.group])
+                {
+                    continue;
+                }
+
+                YAML::Node node = field.group ? componentData[field.group][field.name] : componentData[field.name];
+                if (node)
+                {
+                    m_values.push_back(Value{metadata->id, &field, readValue(node, field.type)});
+                }
+            }
+        }
+
+        if (auto rendererComponent = data["Renderer"])
+        {
+            m_rendererColor = rendererComponent["Material"]["Color"].as<sf::Color>();
+        }
+    }
+
+    ComponentList Prefab::createComponents() const
+    {
+        ComponentList components;
+        components.reserve(m_types.size());
+        for (auto &[type, factory] : m_types)
+        {
+            components.emplace_back(type, factory());
+        }
+        return components;
+    }
+
+    void Prefab::applyTo(Entity &entity) const
+    {
+        entity.setTags(m_tags);
+        entity.setLayer(m_layer);
+
+        // The values of a component are next to each other, it is looked up and marked changed once
+        Component *component = nullptr;
+        bool changed = false;
+        for (std::size_t i = 0; i < m_values.size(); i++)
+        {
+            const Value &preset = m_values[i];
+            if (i == 0 || preset.type != m_values[i - 1].type)
+            {
+                component = entity.getComponent(preset.type);
+                changed = false;
+            }
+
+            if (component)
+            {
+                changed |= Reflection::visit(*component, *preset.field, [&](auto &value)
+                                             {
+                    using T = std::decay_t<decltype(value)>;
+                    const T &wanted = std::get<T>(preset.value);
+                    if (value == wanted)
+                    {
+                        return false;
+                    }
+                    value = wanted;
+                    return true; });
+            }
+
+            if (component && changed && (i + 1 == m_values.size() || m_values[i + 1].type != preset.type))
+            {
+                component->markChanged();
+            }
+        }
+
+        if (m_rendererColor)
+        {
+            if (auto renderer = entity.getComponent<Renderer>())
+            {
+                renderer->material.color = *m_rendererColor;
+            }
+        }
+    }
+} // namespace wpwp
@@ -0,0 +1,121 @@
+#ifndef PREFAB_HPP
+#define PREFAB_HPP
+
+#include <SFML/Graphics/Color.hpp>
+#include <yaml-cpp/yaml.h>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+#include "Archetype.hpp"
+#include "ComponentType.hpp"
+#include "Reflection.hpp"
+#include "Registry.hpp"
+#include "Tags.hpp"
+
+namespace wpwp
+{
+    class Entity;
+
+    /**
+     * @brief Template for spawning copies of an entity, see Entity::instantiate(const Prefab &, ...).
+     *
+     * The entity's serialized form is read once when the prefab is made, into its component types and reflected field values,
+     * so spawning only has to construct the components and copy the values over, without touching YAML.
+     * Children of the source entity aren't part of the prefab.
+     */
+    class Prefab
+    {
+    public:
+        Prefab() = default;
+
+        /**
+         * @brief Captures an existing entity and its components.
+         *
+         * @param entity The entity to capture.
+         */
+        explicit Prefab(const Entity &entity);
+
+        /**
+         * @brief Loads an entity from a scene file as the prefab.
+         *
+         * @param scene The name of the scene, as passed to SceneSerializer::deserialize.
+         * @param entityName The name of the entity inside the scene.
+         * @return True if the entity was found.
+         */
+        bool loadFromScene(const std::filesystem::path &scene, const std::string &entityName);
+
+        /**
+         * @brief Checks if the prefab holds an entity.
+         *
+         * @return True if the prefab was captured or loaded.
+         */
+        bool isValid() const { return m_valid; }
+
+        /**
+         * @brief Gets the name given to the copies.
+         *
+         * @return The name of the prefab.
+         */
+        const std::string &getName() const { return m_name; }
+
+        /**
+         * @brief Gets the component types of the copies.
+         *
+         * @return The type mask of the prefab.
+         */
+        const ComponentMask &getComponentMask() const { return m_mask; }
+
+        /**
+         * @brief Makes destroyed copies get recycled instead of freed.
+         * A recycled copy is kept with its components, deactivated, and handed back out by the next spawn of a prefab with the same
+         * component types, with the prefab's values applied again. Meant for short lived entities spawned in large numbers, e.g. bullets.
+         *
+         * @param recycling True to recycle the copies spawned from now on.
+         */
+        void setRecycling(bool recycling) { m_recycling = recycling; }
+
+        bool isRecycling() const { return m_recycling; }
+
+    private:
+        /**
+         * @brief Reads the serialized entity into component types and field values.
+         */
+        void setData(const YAML::Node &data);
+
+        /**
+         * @brief Constructs a fresh set of the prefab's components.
+         */
+        ComponentList createComponents() const;
+
+        /**
+         * @brief Applies the stored component values to a copy.
+         */
+        void applyTo(Entity &entity) const;
+
+        /**
+         * @brief A reflected value given to the copies.
+         */
+        struct Value
+        {
+            ComponentTypeId type;         // Type of the component holding the field.
+            const FieldDescriptor *field; // The field, owned by the registry.
+            FieldValue value;             // The value to apply.
+        };
+
+    private:
+        std::string m_name;                                                     // Name given to the copies.
+        bool m_valid = false;                                                   // Whether an entity was captured or loaded.
+        std::vector<std::pair<ComponentTypeId, Registry::FactoryFunc>> m_types; // Type id and factory of every component.
+        ComponentMask m_mask;                                                   // Types of all the components.
+        std::vector<Value> m_values;                                            // Field values, grouped by component.
+        TagMask m_tags = 0;                                                     // Tags of the copies.
+        Layer m_layer = 0;                                                      // Layer of the copies.
+        std::optional<sf::Color> m_rendererColor;                               // Color from a scene saved before renderers were reflected.
+        bool m_recycling = false;                                               // Whether destroyed copies are recycled.
+
+        friend class Entity;
+    };
+} // namespace wpwp
+
+#endif // PREFAB_HPP
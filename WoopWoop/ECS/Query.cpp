@@ -0,0 +1,49 @@
+#include "Query.hpp"
+
+namespace wpwp
+{
+    QueryBase::QueryBase(std::vector<ComponentTypeId> types) : m_types(std::move(types))
+    {
+        for (ComponentTypeId type : m_types)
+        {
+            m_mask.set(type);
+        }
+
+        ArchetypeStorage::getInstance().registerQuery(*this);
+    }
+
+    QueryBase::~QueryBase()
+    {
+        ArchetypeStorage::getInstance().unregisterQuery(*this);
+    }
+
+    std::size_t QueryBase::count() const
+    {
+        std::size_t total = 0;
+        for (Archetype *archetype : m_archetypes)
+        {
+            for (Entity *entity : archetype->getEntities())
+            {
+                if (accepts(*entity))
+                {
+                    total++;
+                }
+            }
+        }
+        return total;
+    }
+
+    void QueryBase::tryMatch(Archetype &archetype)
+    {
+        if (!archetype.getMask().contains(m_mask))
+        {
+            return;
+        }
+
+        m_archetypes.push_back(&archetype);
+        for (ComponentTypeId type : m_types)
+        {
+            m_columns.push_back(archetype.getColumnIndex(type));
+        }
+    }
+} // namespace wpwp
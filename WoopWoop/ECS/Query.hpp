@@ -0,0 +1,182 @@
+#ifndef QUERY_HPP
+#define QUERY_HPP
+
+#include <array>
+#include <vector>
+#include <utility>
+#include <type_traits>
+#include "ComponentType.hpp"
+#include "Archetype.hpp"
+#include "Entity.hpp"
+
+namespace wpwp
+{
+    /**
+     * @brief Type erased part of a query, the list of archetypes that match a set of component types.
+     *
+     * Queries register themselves with the ArchetypeStorage and get told about every archetype it creates,
+     * so the match list is kept up to date without ever rescanning the world.
+     * Entities gaining or losing components just move between archetypes and need no bookkeeping at all.
+     */
+    class QueryBase
+    {
+    public:
+        QueryBase(const QueryBase &) = delete;
+        QueryBase &operator=(const QueryBase &) = delete;
+
+        /**
+         * @brief Gets the amount of archetypes matching the query.
+         *
+         * @return The matching archetype count.
+         */
+        std::size_t getArchetypeCount() const { return m_archetypes.size(); }
+
+        /**
+         * @brief Gets a matching archetype.
+         *
+         * @param index The index of the match.
+         * @return Reference to the archetype.
+         */
+        Archetype &getArchetype(std::size_t index) const { return *m_archetypes[index]; }
+
+        /**
+         * @brief Gets the amount of instantiated entities matching the query.
+         *
+         * @return The entity count.
+         */
+        std::size_t count() const;
+
+        /**
+         * @brief Only matches entities with every tag of required and none of excluded.
+         *
+         * @param required The tags an entity must have.
+         * @param excluded The tags an entity must not have.
+         */
+        void setTagFilter(TagMask required, TagMask excluded = 0)
+        {
+            m_requiredTags = required;
+            m_excludedTags = excluded;
+        }
+
+        /**
+         * @brief Only matches entities on one of the given layers.
+         *
+         * @param layers The accepted layers, ALL_LAYERS by default.
+         */
+        void setLayerFilter(LayerMask layers) { m_layers = layers; }
+
+    protected:
+        /**
+         * @brief Registers the query and matches it against the archetypes that already exist.
+         *
+         * @param types The component types an archetype must have to match.
+         */
+        explicit QueryBase(std::vector<ComponentTypeId> types);
+        ~QueryBase();
+
+        /**
+         * @brief Gets the column of a query term inside a matching archetype.
+         *
+         * @param index The index of the match.
+         * @param term The index of the type in the query's type list.
+         * @return The column index.
+         */
+        int getColumn(std::size_t index, std::size_t term) const { return m_columns[index * m_types.size() + term]; }
+
+        /**
+         * @brief Checks if an entity of a matching archetype is instantiated and passes the tag and layer filters.
+         */
+        bool accepts(const Entity &entity) const
+        {
+            TagMask tags = entity.getTags();
+            return entity.isInstantiated() && (tags & m_requiredTags) == m_requiredTags && !(tags & m_excludedTags) &&
+                   (m_layers & layerBit(entity.getLayer()));
+        }
+
+    private:
+        /**
+         * @brief Adds the archetype to the matches if it has every type of the query.
+         */
+        void tryMatch(Archetype &archetype);
+
+    private:
+        ComponentMask m_mask;                  // Types required by the query.
+        std::vector<ComponentTypeId> m_types;  // Types of the query, in declaration order.
+        std::vector<Archetype *> m_archetypes; // Matching archetypes.
+        std::vector<int> m_columns;            // Column of each type for each match, m_types.size() entries per match.
+        TagMask m_requiredTags = 0;            // Tags a matching entity must have.
+        TagMask m_excludedTags = 0;            // Tags a matching entity must not have.
+        LayerMask m_layers = ALL_LAYERS;       // Layers a matching entity can be on.
+
+        friend class ArchetypeStorage;
+    };
+
+    /**
+     * @brief Persistent query over every entity that has all of the given component types.
+     *
+     * Create it once (e.g. as a member of a system) and iterate it every frame,
+     * iteration only touches the matching archetypes and never allocates.
+     * Types are matched exactly, a query for a base type (e.g. Renderer) won't match its derived types.
+     * Entities can be narrowed down further by tags and layers, see setTagFilter() and setLayerFilter().
+     *
+     * @code
+     * Query<Transform, PhysicsBody2D> bodies;
+     * bodies.forEach([](Entity &entity, Transform &transform, PhysicsBody2D &body) { ... });
+     * @endcode
+     *
+     * @tparam Ts The component types to match.
+     */
+    template <typename... Ts>
+    class Query : public QueryBase
+    {
+        static_assert(sizeof...(Ts) > 0, "A query needs at least one component type");
+        static_assert((std::is_base_of<Component, Ts>::value && ...), "Ts must inherit from Component");
+
+    public:
+        Query() : QueryBase({ComponentTypes::get<Ts>()...}) {}
+
+        /**
+         * @brief Calls a function for every instantiated entity matching the query.
+         * Don't add or remove components or entities from inside the function, record them in a CommandBuffer instead.
+         *
+         * @param func Callable taking (Ts&...) or (Entity&, Ts&...).
+         */
+        template <typename Func>
+        void forEach(Func &&func) const
+        {
+            for (std::size_t i = 0; i < getArchetypeCount(); i++)
+            {
+                forEachRow(i, func, std::index_sequence_for<Ts...>{});
+            }
+        }
+
+    private:
+        template <typename Func, std::size_t... Is>
+        void forEachRow(std::size_t index, Func &func, std::index_sequence<Is...>) const
+        {
+            Archetype &archetype = getArchetype(index);
+            const auto &entities = archetype.getEntities();
+            const std::array<std::vector<std::shared_ptr<Component>> *, sizeof...(Ts)> columns{&archetype.getColumn(getColumn(index, Is))...};
+
+            for (std::size_t row = 0; row < entities.size(); row++)
+            {
+                Entity *entity = entities[row];
+                if (!accepts(*entity))
+                {
+                    continue;
+                }
+
+                if constexpr (std::is_invocable_v<Func &, Entity &, Ts &...>)
+                {
+                    func(*entity, *static_cast<Ts *>((*columns[Is])[row].get())...);
+                }
+                else
+                {
+                    func(*static_cast<Ts *>((*columns[Is])[row].get())...);
+                }
+            }
+        }
+    };
+} // namespace wpwp
+
+#endif // QUERY_HPP
@@ -0,0 +1,93 @@
+#include "Reflection.hpp"
+#include "Component.hpp"
+#include "imgui/imgui.h"
+#include <cstring>
+
+namespace wpwp
+{
+    namespace
+    {
+        struct FieldDrawer
+        {
+            const FieldDescriptor &field;
+
+            bool hasRange() const { return field.min != field.max; }
+
+            bool operator()(bool &value) const { return ImGui::Checkbox(field.name, &value); }
+
+            bool operator()(int &value) const
+            {
+                return hasRange() ? ImGui::SliderInt(field.name, &value, static_cast<int>(field.min), static_cast<int>(field.max))
+                                  : ImGui::InputInt(field.name, &value);
+            }
+
+            bool operator()(float &value) const
+            {
+                return hasRange() ? ImGui::SliderFloat(field.name, &value, field.min, field.max)
+                                  : ImGui::InputFloat(field.name, &value);
+            }
+
+            bool operator()(std::string &value) const
+            {
+                char buffer[256];
+                std::strncpy(buffer, value.c_str(), sizeof(buffer) - 1);
+                buffer[sizeof(buffer) - 1] = '\0';
+
+                if (!ImGui::InputText(field.name, buffer, sizeof(buffer)))
+                {
+                    return false;
+                }
+                value = buffer;
+                return true;
+            }
+
+            bool operator()(sf::Vector2f &value) const
+            {
+                float v[2] = {value.x, value.y};
+                bool changed = hasRange() ? ImGui::SliderFloat2(field.name, v, field.min, field.max)
+                                          : ImGui::InputFloat2(field.name, v);
+                value = {v[0], v[1]};
+                return changed;
+            }
+
+            bool operator()(sf::Vector3f &value) const
+            {
+                float v[3] = {value.x, value.y, value.z};
+                bool changed = hasRange() ? ImGui::SliderFloat3(field.name, v, field.min, field.max)
+                                          : ImGui::InputFloat3(field.name, v);
+                value = {v[0], v[1], v[2]};
+                return changed;
+            }
+
+            bool operator()(sf::Color &value) const
+            {
+                float col[4] = {value.r / 255.0f, value.g / 255.0f, value.b / 255.0f, value.a / 255.0f};
+                if (!ImGui::ColorEdit4(field.name, col))
+                {
+                    return false;
+                }
+                value = sf::Color(col[0] * 255.0f, col[1] * 255.0f, col[2] * 255.0f, col[3] * 255.0f);
+                return true;
+            }
+        };
+    }
+
+    void Reflection::drawFields(Component &component)
+    {
+        for (const FieldDescriptor &field : getFields(component.getTypeId()))
+        {
+            if (visit(component, field, FieldDrawer{field}))
+            {
+                component.markChanged();
+            }
+        }
+    }
+
+    const std::vector<FieldDescriptor> &Reflection::getFields(ComponentTypeId type)
+    {
+        static const std::vector<FieldDescriptor> none;
+
+        const Registry::TypeMetadata *metadata = Registry::getInstance().getMetadata(type);
+        return metadata ? metadata->fields : none;
+    }
+} // namespace wpwp
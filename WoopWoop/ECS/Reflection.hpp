@@ -0,0 +1,232 @@
+#ifndef REFLECTION_HPP
+#define REFLECTION_HPP
+
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <SFML/System/Vector3.hpp>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <variant>
+#include <vector>
+#include "ComponentType.hpp"
+
+/**
+ * @brief Describes a data member inside WREGISTER, the member has to be accessible from namespace scope.
+ *
+ * @param name Key in the scene file and label in the inspector.
+ * @param member The member, nested members like material.color work too.
+ * @param ... Optional minimum and maximum for the inspector.
+ */
+#define WFIELD(name, member, ...) \
+    wpwp::Reflection::field<Self>(name, [](Self *self) { return &self->member; } __VA_OPT__(, ) __VA_ARGS__)
+
+/**
+ * @brief Describes a value reached through accessors inside WREGISTER, for state that isn't a plain member.
+ *
+ * @param name Key in the scene file and label in the inspector.
+ * @param getter Expression reading the value from self.
+ * @param setter Statement writing value to self, wrapped in parentheses if it contains commas.
+ */
+#define WPROPERTY(name, getter, setter)                                             \
+    wpwp::Reflection::property<Self>(name, [](Self &self) { return getter; },       \
+                                     [](Self &self, const auto &value) { setter; })
+
+namespace wpwp
+{
+    struct Component;
+
+    /**
+     * @brief Value types a reflected field can have.
+     */
+    enum class FieldType
+    {
+        Bool,
+        Int,
+        Float,
+        String,
+        Vector2f,
+        Vector3f,
+        Color
+    };
+
+    /**
+     * @brief A reflected value of any of the field types, only used for fields behind accessors.
+     */
+    using FieldValue = std::variant<bool, int, float, std::string, sf::Vector2f, sf::Vector3f, sf::Color>;
+
+    /**
+     * @brief Describes one serialized and inspected value of a component type.
+     */
+    struct FieldDescriptor
+    {
+        const char *name;                                         // Key in the scene file and label in the inspector.
+        FieldType type;                                           // Type of the value.
+        std::size_t offset = 0;                                   // Offset of the member from the Component base, for plain members.
+        float min = 0.0f;                                         // Lowest value the inspector allows, unused when min == max.
+        float max = 0.0f;                                         // Highest value the inspector allows.
+        const char *group = nullptr;                              // Map the value is nested in inside the component's entry, if any.
+        std::function<FieldValue(Component &)> get;               // Reads the value, set for accessor fields only.
+        std::function<void(Component &, const FieldValue &)> set; // Writes the value, set for accessor fields only.
+
+        /**
+         * @brief Nests the value in a map inside the component's entry.
+         *
+         * @param groupName Key of the map.
+         * @return The descriptor, for chaining inside WREGISTER.
+         */
+        FieldDescriptor inGroup(const char *groupName) &&
+        {
+            group = groupName;
+            return std::move(*this);
+        }
+    };
+
+    /**
+     * @brief Builds field descriptors and walks them.
+     */
+    class Reflection
+    {
+    public:
+        /**
+         * @brief Gets the field type of a C++ type, fails to compile for unsupported types.
+         */
+        template <typename T>
+        static constexpr FieldType typeOf()
+        {
+            if constexpr (std::is_same_v<T, bool>)
+                return FieldType::Bool;
+            else if constexpr (std::is_same_v<T, int>)
+                return FieldType::Int;
+            else if constexpr (std::is_same_v<T, float>)
+                return FieldType::Float;
+            else if constexpr (std::is_same_v<T, std::string>)
+                return FieldType::String;
+            else if constexpr (std::is_same_v<T, sf::Vector2f>)
+                return FieldType::Vector2f;
+            else if constexpr (std::is_same_v<T, sf::Vector3f>)
+                return FieldType::Vector3f;
+            else
+            {
+                static_assert(std::is_same_v<T, sf::Color>, "Unsupported field type");
+                return FieldType::Color;
+            }
+        }
+
+        /**
+         * @brief Describes a member of T by its offset from the Component base.
+         *
+         * @param name Key in the scene file and label in the inspector.
+         * @param access Returns the member's address given an object, only used for address arithmetic.
+         * @param min Lowest value the inspector allows.
+         * @param max Highest value the inspector allows.
+         */
+        template <typename T, typename Member>
+        static FieldDescriptor field(const char *name, Member *(*access)(T *), float min = 0.0f, float max = 0.0f)
+        {
+            // Never constructed, the member's address is only compared against the base's
+            alignas(T) static unsigned char storage[sizeof(T)];
+            T *object = reinterpret_cast<T *>(storage);
+            auto base = reinterpret_cast<unsigned char *>(static_cast<Component *>(object));
+            auto member = reinterpret_cast<unsigned char *>(access(object));
+
+            return FieldDescriptor{name, typeOf<std::remove_cv_t<Member>>(), static_cast<std::size_t>(member - base), min, max};
+        }
+
+        template <typename T, typename Access>
+        static FieldDescriptor field(const char *name, Access access, float min = 0.0f, float max = 0.0f)
+        {
+            using Member = std::remove_pointer_t<decltype(access(static_cast<T *>(nullptr)))>;
+            return field<T, Member>(name, static_cast<Member *(*)(T *)>(access), min, max);
+        }
+
+        /**
+         * @brief Describes a value of T read and written through accessors.
+         *
+         * @param name Key in the scene file and label in the inspector.
+         * @param get Returns the value given an object.
+         * @param set Writes the value given an object.
+         */
+        template <typename T, typename Get, typename Set>
+        static FieldDescriptor property(const char *name, Get get, Set set)
+        {
+            using Value = std::decay_t<decltype(get(std::declval<T &>()))>;
+
+            FieldDescriptor descriptor{name, typeOf<Value>()};
+            descriptor.get = [get](Component &component) -> FieldValue
+            { return get(static_cast<T &>(component)); };
+            descriptor.set = [set](Component &component, const FieldValue &value)
+            { set(static_cast<T &>(component), std::get<Value>(value)); };
+            return descriptor;
+        }
+
+        /**
+         * @brief Calls visitor with a reference to the field's value, writing it back if the visitor returns true.
+         * Plain members are handed over in place, accessor fields go through a copy.
+         *
+         * @param component The component holding the field.
+         * @param field The field to visit.
+         * @param visitor Callable taking any field type by reference and returning whether it changed the value.
+         * @return True if the value changed.
+         */
+        template <typename Visitor>
+        static bool visit(Component &component, const FieldDescriptor &field, Visitor &&visitor)
+        {
+            switch (field.type)
+            {
+            case FieldType::Bool:
+                return visitAs<bool>(component, field, visitor);
+            case FieldType::Int:
+                return visitAs<int>(component, field, visitor);
+            case FieldType::Float:
+                return visitAs<float>(component, field, visitor);
+            case FieldType::String:
+                return visitAs<std::string>(component, field, visitor);
+            case FieldType::Vector2f:
+                return visitAs<sf::Vector2f>(component, field, visitor);
+            case FieldType::Vector3f:
+                return visitAs<sf::Vector3f>(component, field, visitor);
+            case FieldType::Color:
+                return visitAs<sf::Color>(component, field, visitor);
+            }
+            return false;
+        }
+
+        /**
+         * @brief Draws inspector widgets for every reflected field of a component, marking it changed on edits.
+         *
+         * @param component The component to draw.
+         */
+        static void drawFields(Component &component);
+
+        /**
+         * @brief Gets the reflected fields of a registered type, a table lookup.
+         *
+         * @param type The type id, e.g. the one of the column holding a component (Component::getTypeId()).
+         * @return The fields, empty for unregistered types.
+         */
+        static const std::vector<FieldDescriptor> &getFields(ComponentTypeId type);
+
+    private:
+        template <typename T, typename Visitor>
+        static bool visitAs(Component &component, const FieldDescriptor &field, Visitor &visitor)
+        {
+            if (field.get)
+            {
+                T value = std::get<T>(field.get(component));
+                if (!visitor(value))
+                {
+                    return false;
+                }
+
+                field.set(component, value);
+                return true;
+            }
+
+            return visitor(*reinterpret_cast<T *>(reinterpret_cast<unsigned char *>(&component) + field.offset));
+        }
+    };
+} // namespace wpwp
+
+#endif // REFLECTION_HPP
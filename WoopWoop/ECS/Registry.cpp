@@ -1,5 +1,6 @@
 #include "Registry.hpp"
 #include "Component.hpp"
+#include <algorithm>
 
 using namespace wpwp;
 
@@ -9,41 +10,91 @@ Registry &Registry::getInstance()
     return instance;
 }
 
-void Registry::registerType(const std::string &typeName, FactoryFunc factory)
+void Registry::registerType(TypeMetadata metadata)
 {
-    factoryMap[typeName] = factory;
+    if (m_lookup.find(metadata.name) != m_lookup.end())
+    {
+        return;
+    }
+
+    metadata.symbol = intern(metadata.name);
+    m_typeNames[metadata.id] = metadata.symbol;
+
+    const TypeMetadata &entry = m_types.emplace_back(std::move(metadata));
+    m_lookup.emplace(entry.name, &entry);
+    m_byId[entry.id] = &entry;
+    m_names.insert(std::upper_bound(m_names.begin(), m_names.end(), entry.name), entry.name);
+}
+
+const Registry::TypeMetadata *Registry::getMetadata(std::string_view typeName) const
+{
+    auto it = m_lookup.find(typeName);
+    if (it != m_lookup.end())
+    {
+        return it->second;
+    }
+    return nullptr;
+}
+
+Registry::Symbol Registry::intern(std::string_view name)
+{
+    if (Symbol symbol = findSymbol(name))
+    {
+        return symbol;
+    }
+
+    // A deque never moves its strings, so the lookup can view them
+    Symbol symbol = static_cast<Symbol>(m_strings.size());
+    const std::string &stored = m_strings.emplace_back(name);
+    m_symbols.emplace(stored, symbol);
+    return symbol;
+}
+
+Registry::Symbol Registry::findSymbol(std::string_view name) const
+{
+    auto it = m_symbols.find(name);
+    if (it != m_symbols.end())
+    {
+        return it->second;
+    }
+    return NO_SYMBOL;
 }
 
-std::shared_ptr<Component> Registry::createInstance(const std::string &typeName) const
+Registry::Symbol Registry::nameType(ComponentTypeId id, const Component &component)
 {
-    auto it = factoryMap.find(typeName);
-    if (it != factoryMap.end())
+    if (m_typeNames[id] == NO_SYMBOL)
     {
-        return it->second();
+        m_typeNames[id] = intern(component.getName());
+    }
+    return m_typeNames[id];
+}
+
+std::shared_ptr<Component> Registry::createInstance(std::string_view typeName) const
+{
+    const TypeMetadata *metadata = getMetadata(typeName);
+    if (metadata)
+    {
+        return metadata->factory();
     }
     return nullptr;
 }
 
-std::vector<std::string> Registry::getAllRegistered() const
+Registry::FactoryFunc Registry::getFactory(std::string_view typeName) const
 {
-    std::vector<std::string> registeredTypes;
-    for (const auto &pair : factoryMap)
+    const TypeMetadata *metadata = getMetadata(typeName);
+    if (metadata)
     {
-        registeredTypes.push_back(pair.first);
+        return metadata->factory;
     }
-    return registeredTypes;
+    return nullptr;
 }
 
-const std::type_info *Registry::getType(const std::string &typeName) const
+const std::type_info *Registry::getType(std::string_view typeName) const
 {
-    auto it = factoryMap.find(typeName);
-    if (it != factoryMap.end())
+    const TypeMetadata *metadata = getMetadata(typeName);
+    if (metadata)
     {
-        std::shared_ptr<Component> instance = it->second();
-        if (instance)
-        {
-            return &typeid(*instance);
-        }
+        return metadata->type;
     }
     return nullptr;
-}
\ No newline at end of file
+}
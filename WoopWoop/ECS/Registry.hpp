@@ -1,10 +1,17 @@
 #pragma once
 
+#include <array>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
-#include <map>
 #include <typeinfo>
 #include <iostream>
+#include "ComponentType.hpp"
+#include "Reflection.hpp"
 
 namespace wpwp
 {
@@ -18,6 +25,27 @@ namespace wpwp
         // Function pointer type for creating instances of Component.
         using FactoryFunc = std::shared_ptr<Component> (*)();
 
+        /// @brief Interned component type name, two symbols are equal only if their names are.
+        using Symbol = std::uint32_t;
+
+        /// @brief Symbol of no name, never handed out by intern().
+        static constexpr Symbol NO_SYMBOL = 0;
+
+        /// @brief Everything known about a registered component type, built once at registration.
+        struct TypeMetadata
+        {
+            std::string name;           // Registered name of the type, the entry's address is stable so it can be kept around.
+            Symbol symbol;              // Interned name of the type.
+            const std::type_info *type; // Runtime type of the components.
+            ComponentTypeId id;         // Dense id of the type.
+            std::size_t size;           // Size of a component, in bytes.
+            std::size_t alignment;      // Alignment of a component, in bytes.
+            FactoryFunc factory;        // Creates a default constructed component.
+            bool hasUpdate;             // Flag indicating whether the type overrides Component::update().
+
+            std::vector<FieldDescriptor> fields; // Serialized and inspected values, in declaration order.
+        };
+
         /** @brief Get the singleton instance of Registry.
          *
          * @return Reference to the singleton instance of Registry.
@@ -25,31 +53,97 @@ namespace wpwp
         static Registry &getInstance();
 
         /** @brief Register a component type with its factory function.
+         * Registering a name again is ignored, WREGISTER runs once per translation unit including the type's header.
          *
+         * @tparam T The component type.
          * @param typeName The name of the component type.
          * @param factory The factory function that creates instances of the component type.
+         * @param fields The reflected fields of the component type.
          */
-        void registerType(const std::string &typeName, FactoryFunc factory);
+        template <typename T>
+        void registerType(const std::string &typeName, FactoryFunc factory, std::vector<FieldDescriptor> fields = {})
+        {
+            registerType(TypeMetadata{typeName, NO_SYMBOL, &typeid(T), ComponentTypes::get<T>(), sizeof(T), alignof(T), factory, overridesUpdate<T>, std::move(fields)});
+        }
+
+        /** @brief Get the metadata of a component type by its name.
+         *
+         * @param typeName The name of the component type.
+         * @return Pointer to the metadata, or nullptr if not found.
+         */
+        const TypeMetadata *getMetadata(std::string_view typeName) const;
+
+        /** @brief Get the metadata of a component type by its type id.
+         *
+         * @param id The type id of the component type.
+         * @return Pointer to the metadata, or nullptr if the type wasn't registered.
+         */
+        const TypeMetadata *getMetadata(ComponentTypeId id) const { return id < m_byId.size() ? m_byId[id] : nullptr; }
+
+        /** @brief Intern a name, the same name always gets the same symbol.
+         * Only called from the main thread, as types get registered or first added to an entity.
+         *
+         * @param name The name to intern.
+         * @return The symbol of the name.
+         */
+        Symbol intern(std::string_view name);
+
+        /** @brief Get the symbol of a name without interning it.
+         *
+         * @param name The name to look up.
+         * @return The symbol of the name, or NO_SYMBOL if the name was never interned.
+         */
+        Symbol findSymbol(std::string_view name) const;
+
+        /** @brief Get the name a symbol was interned from.
+         *
+         * @param symbol The symbol.
+         * @return The name, empty for NO_SYMBOL.
+         */
+        const std::string &getString(Symbol symbol) const { return m_strings[symbol]; }
+
+        /** @brief Get the interned name of a component type.
+         * Registered types are named at registration, the others by nameType() when first added to an entity.
+         *
+         * @param id The type id of the component type.
+         * @return The symbol of the type's name, or NO_SYMBOL if the type wasn't named yet.
+         */
+        Symbol getTypeName(ComponentTypeId id) const { return m_typeNames[id]; }
+
+        /** @brief Name a component type after one of its components, once per type.
+         *
+         * @param id The type id of the component type.
+         * @param component A component of that type, its getName() is interned if the type has no name yet.
+         * @return The symbol of the type's name.
+         */
+        Symbol nameType(ComponentTypeId id, const Component &component);
 
         /** @brief Create an instance of a component by its type name.
          *
          * @param typeName The name of the component type to create.
          * @return A shared pointer to the created component instance, or nullptr if not found.
          */
-        std::shared_ptr<Component> createInstance(const std::string &typeName) const;
+        std::shared_ptr<Component> createInstance(std::string_view typeName) const;
+
+        /** @brief Get the factory function of a component type by its name.
+         *
+         * @param typeName The name of the component type.
+         * @return The factory function, or nullptr if not found.
+         */
+        FactoryFunc getFactory(std::string_view typeName) const;
 
         /** @brief Get a list of all registered component type names.
          *
-         * @return A vector of strings containing the names of all registered component types.
+         * @return The names of all registered component types, sorted.
          */
-        std::vector<std::string> getAllRegistered() const;
+        const std::vector<std::string> &getAllRegistered() const { return m_names; }
 
         /** @brief Get the type_info of a component by its name.
          *
          * @param typeName The name of the component type.
          * @return The type_info of the component type, or nullptr if not found.
          */
-        const std::type_info *getType(const std::string &typeName) const;
+        const std::type_info *getType(std::string_view typeName) const;
 
         /** @brief Get the type_info of a component by its name and convert it to a template argument.
          *
@@ -77,7 +171,21 @@ namespace wpwp
         /// @brief Private constructor to enforce singleton pattern.
         Registry() = default;
 
-        /// Map of component type names to their factory functions.
-        std::map<std::string, FactoryFunc> factoryMap;
+        void registerType(TypeMetadata metadata);
+
+        /// @brief Transparent hash, so lookups by string_view don't build a std::string.
+        struct NameHash
+        {
+            using is_transparent = void;
+            std::size_t operator()(std::string_view name) const { return std::hash<std::string_view>()(name); }
+        };
+
+        std::deque<TypeMetadata> m_types;                                                          // Metadata of every registered type, in registration order.
+        std::unordered_map<std::string, const TypeMetadata *, NameHash, std::equal_to<>> m_lookup; // Name to metadata lookup.
+        std::array<const TypeMetadata *, MAX_COMPONENT_TYPES> m_byId{};                            // Type id to metadata lookup.
+        std::vector<std::string> m_names;                                                          // Registered names, sorted.
+        std::deque<std::string> m_strings{std::string()};                                          // Interned names, indexed by symbol, NO_SYMBOL's is empty.
+        std::unordered_map<std::string_view, Symbol> m_symbols;                                    // Interned name to symbol lookup, viewing m_strings.
+        std::array<Symbol, MAX_COMPONENT_TYPES> m_typeNames{};                                     // Type id to interned name.
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,530 @@
+#include "SpatialIndex.hpp"
+#include "Entity.hpp"
+#include "Components/Transform.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace wpwp
+{
+    namespace
+    {
+        // Far enough for any sane world, keeps the cell coordinates away from overflowing
+        constexpr float MAX_CELL = float(1 << 30);
+
+        float right(const sf::FloatRect &rect) { return rect.left + rect.width; }
+        float bottom(const sf::FloatRect &rect) { return rect.top + rect.height; }
+
+        bool overlaps(const sf::FloatRect &a, const sf::FloatRect &b)
+        {
+            return a.left <= right(b) && b.left <= right(a) && a.top <= bottom(b) && b.top <= bottom(a);
+        }
+
+        float distanceSquared(const sf::FloatRect &rect, sf::Vector2f point)
+        {
+            float dx = std::max({rect.left - point.x, 0.0f, point.x - right(rect)});
+            float dy = std::max({rect.top - point.y, 0.0f, point.y - bottom(rect)});
+            return dx * dx + dy * dy;
+        }
+
+        /**
+         * @brief Clips a ray against a rectangle with the slab method.
+         *
+         * @return True if the ray enters the rectangle between tMin and tMax, which are narrowed to the part inside it.
+         */
+        bool clipRay(const sf::FloatRect &rect, sf::Vector2f origin, sf::Vector2f direction, float &tMin, float &tMax)
+        {
+            const float low[2] = {rect.left, rect.top};
+            const float high[2] = {right(rect), bottom(rect)};
+            const float start[2] = {origin.x, origin.y};
+            const float step[2] = {direction.x, direction.y};
+
+            for (int axis = 0; axis < 2; axis++)
+            {
+                if (step[axis] == 0.0f)
+                {
+                    if (start[axis] < low[axis] || start[axis] > high[axis])
+                    {
+                        return false;
+                    }
+                    continue;
+                }
+
+                float t0 = (low[axis] - start[axis]) / step[axis];
+                float t1 = (high[axis] - start[axis]) / step[axis];
+                if (t0 > t1)
+                {
+                    std::swap(t0, t1);
+                }
+
+                tMin = std::max(tMin, t0);
+                tMax = std::min(tMax, t1);
+                if (tMin > tMax)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        sf::FloatRect boundsOf(Transform &transform)
+        {
+            const sf::Vector3f &position = *transform.getPosition();
+            const sf::Vector3f &scale = *transform.getScale();
+
+            // The box of the scale, rotated around its center and fitted back into an axis aligned box
+            float radians = transform.getRotation()->z * 3.14159265f / 180.0f;
+            float cos = std::abs(std::cos(radians));
+            float sin = std::abs(std::sin(radians));
+            float halfWidth = (cos * std::abs(scale.x) + sin * std::abs(scale.y)) / 2.0f;
+            float halfHeight = (sin * std::abs(scale.x) + cos * std::abs(scale.y)) / 2.0f;
+
+            return sf::FloatRect(position.x - halfWidth, position.y - halfHeight, halfWidth * 2.0f, halfHeight * 2.0f);
+        }
+    }
+
+    SpatialIndex &SpatialIndex::getInstance()
+    {
+        static SpatialIndex instance;
+        return instance;
+    }
+
+    SpatialIndex::SpatialIndex()
+    {
+        Entity::onEntitiesCreated += [this](std::span<const EntityId> ids)
+        {
+            m_created.insert(m_created.end(), ids.begin(), ids.end());
+        };
+
+        Entity::onEntitiesDestroyed += [this](std::span<const EntityId> ids)
+        {
+            for (EntityId id : ids)
+            {
+                remove(id);
+            }
+        };
+
+        Entity::onAllEntitiesDestroyed += [this]()
+        {
+            clear();
+        };
+    }
+
+    void SpatialIndex::refresh()
+    {
+        Transform::takeMoved(m_moved);
+
+        if (m_rebuild)
+        {
+            m_rebuild = false;
+            m_created.clear();
+            for (auto &entity : Entity::getAllEntities())
+            {
+                reinsert(entity->getId());
+            }
+            return;
+        }
+
+        for (EntityId id : m_created)
+        {
+            reinsert(id);
+        }
+        m_created.clear();
+
+        for (EntityId id : m_moved)
+        {
+            reinsert(id);
+        }
+    }
+
+    void SpatialIndex::reinsert(EntityId id)
+    {
+        Entity *entity = Entity::get(id);
+        if (entity && entity->isInstantiated() && entity->transform)
+        {
+            insert(id, boundsOf(*entity->transform));
+        }
+    }
+
+    void SpatialIndex::setCellSize(float cellSize)
+    {
+        if (cellSize <= 0.0f)
+        {
+            ERROR("Spatial index cell size must be positive, got: ", cellSize);
+            return;
+        }
+
+        m_cellSize = cellSize;
+        clear();
+    }
+
+    void SpatialIndex::clear()
+    {
+        m_cells.clear();
+        m_entries.clear();
+        m_count = 0;
+        m_oversized.clear();
+        m_minCell[0] = m_minCell[1] = 0;
+        m_maxCell[0] = m_maxCell[1] = -1;
+        m_rebuild = true;
+    }
+
+    bool SpatialIndex::getBounds(EntityId id, sf::FloatRect &bounds) const
+    {
+        if (id.index >= m_entries.size() || !(m_entries[id.index].id == id))
+        {
+            return false;
+        }
+
+        bounds = m_entries[id.index].bounds;
+        return true;
+    }
+
+    void SpatialIndex::insert(EntityId id, const sf::FloatRect &bounds)
+    {
+        if (id.index >= m_entries.size())
+        {
+            m_entries.resize(id.index + 1);
+        }
+
+        Entry &entry = m_entries[id.index];
+        std::int32_t minX = cellOf(bounds.left), minY = cellOf(bounds.top);
+        std::int32_t maxX = cellOf(right(bounds)), maxY = cellOf(bottom(bounds));
+
+        // Most moves stay inside the same cells, only the bounds need updating then
+        if (entry.id == id && entry.minX == minX && entry.minY == minY && entry.maxX == maxX && entry.maxY == maxY)
+        {
+            entry.bounds = bounds;
+            return;
+        }
+
+        if (!entry.id.isNull())
+        {
+            remove(entry.id);
+        }
+
+        // Capped so an entity's insertion and removal cost a bounded amount of cells
+        const bool oversized = std::int64_t(maxX) - minX >= MAX_CELL_SPAN || std::int64_t(maxY) - minY >= MAX_CELL_SPAN;
+        entry = Entry{id, bounds, minX, minY, maxX, maxY, oversized};
+        m_count++;
+        if (oversized)
+        {
+            m_oversized.push_back(id.index);
+            return;
+        }
+
+        for (std::int32_t y = minY; y <= maxY; y++)
+        {
+            for (std::int32_t x = minX; x <= maxX; x++)
+            {
+                m_cells[keyOf(x, y)].push_back(id.index);
+            }
+        }
+
+        if (!hasOccupiedCells())
+        {
+            m_minCell[0] = minX;
+            m_minCell[1] = minY;
+            m_maxCell[0] = maxX;
+            m_maxCell[1] = maxY;
+        }
+        else
+        {
+            m_minCell[0] = std::min(m_minCell[0], minX);
+            m_minCell[1] = std::min(m_minCell[1], minY);
+            m_maxCell[0] = std::max(m_maxCell[0], maxX);
+            m_maxCell[1] = std::max(m_maxCell[1], maxY);
+        }
+    }
+
+    void SpatialIndex::remove(EntityId id)
+    {
+        if (id.index >= m_entries.size() || !(m_entries[id.index].id == id))
+        {
+            return;
+        }
+
+        Entry &entry = m_entries[id.index];
+        if (entry.oversized)
+        {
+            auto found = std::find(m_oversized.begin(), m_oversized.end(), id.index);
+            *found = m_oversized.back();
+            m_oversized.pop_back();
+
+            entry = Entry{};
+            m_count--;
+            return;
+        }
+
+        for (std::int32_t y = entry.minY; y <= entry.maxY; y++)
+        {
+            for (std::int32_t x = entry.minX; x <= entry.maxX; x++)
+            {
+                auto it = m_cells.find(keyOf(x, y));
+                if (it == m_cells.end())
+                {
+                    continue;
+                }
+
+                // Order inside a cell doesn't matter, swapped with the last one instead of shifting
+                std::vector<std::uint32_t> &cell = it->second;
+                auto found = std::find(cell.begin(), cell.end(), id.index);
+                if (found != cell.end())
+                {
+                    *found = cell.back();
+                    cell.pop_back();
+                }
+
+                if (cell.empty())
+                {
+                    m_cells.erase(it);
+                }
+            }
+        }
+
+        entry = Entry{};
+        m_count--;
+    }
+
+    std::int32_t SpatialIndex::cellOf(float coordinate) const
+    {
+        float cell = std::floor(coordinate / m_cellSize);
+        if (!(cell > -MAX_CELL))
+        {
+            return static_cast<std::int32_t>(-MAX_CELL);
+        }
+        return static_cast<std::int32_t>(std::min(cell, MAX_CELL));
+    }
+
+    std::uint64_t SpatialIndex::keyOf(std::int32_t x, std::int32_t y)
+    {
+        return (std::uint64_t(std::uint32_t(x)) << 32) | std::uint32_t(y);
+    }
+
+    template <typename Func>
+    void SpatialIndex::forEachInRegion(const sf::FloatRect &region, Func func) const
+    {
+        // Cells outside of everything ever inserted are known to be empty
+        std::int32_t minX = std::max(cellOf(region.left), m_minCell[0]);
+        std::int32_t minY = std::max(cellOf(region.top), m_minCell[1]);
+        std::int32_t maxX = std::min(cellOf(right(region)), m_maxCell[0]);
+        std::int32_t maxY = std::min(cellOf(bottom(region)), m_maxCell[1]);
+
+        for (std::int32_t y = minY; y <= maxY; y++)
+        {
+            for (std::int32_t x = minX; x <= maxX; x++)
+            {
+                auto it = m_cells.find(keyOf(x, y));
+                if (it == m_cells.end())
+                {
+                    continue;
+                }
+
+                for (std::uint32_t index : it->second)
+                {
+                    // An entity spanning several cells is only reported from the first one the region shares with it
+                    const Entry &entry = m_entries[index];
+                    if (x == std::max(entry.minX, minX) && y == std::max(entry.minY, minY))
+                    {
+                        func(entry);
+                    }
+                }
+            }
+        }
+
+        for (std::uint32_t index : m_oversized)
+        {
+            func(m_entries[index]);
+        }
+    }
+
+    template <typename Func>
+    void SpatialIndex::walkRay(sf::Vector2f origin, sf::Vector2f direction, float tStart, float tEnd, Func func) const
+    {
+        sf::Vector2f start = origin + direction * tStart;
+        std::int32_t x = cellOf(start.x), y = cellOf(start.y);
+        std::int32_t stepX = direction.x > 0 ? 1 : -1, stepY = direction.y > 0 ? 1 : -1;
+
+        // Distance along the ray to the next vertical and horizontal cell edges, and between two of them
+        float nextX = direction.x != 0 ? ((x + (stepX > 0)) * m_cellSize - origin.x) / direction.x : INFINITY;
+        float nextY = direction.y != 0 ? ((y + (stepY > 0)) * m_cellSize - origin.y) / direction.y : INFINITY;
+        float deltaX = direction.x != 0 ? m_cellSize / std::abs(direction.x) : INFINITY;
+        float deltaY = direction.y != 0 ? m_cellSize / std::abs(direction.y) : INFINITY;
+
+        float t = tStart;
+        while (t <= tEnd)
+        {
+            auto it = m_cells.find(keyOf(x, y));
+            if (it != m_cells.end())
+            {
+                for (std::uint32_t index : it->second)
+                {
+                    func(index);
+                }
+            }
+
+            if (nextX < nextY)
+            {
+                t = nextX;
+                nextX += deltaX;
+                x += stepX;
+            }
+            else
+            {
+                t = nextY;
+                nextY += deltaY;
+                y += stepY;
+            }
+        }
+    }
+
+    void SpatialIndex::queryRegion(const sf::FloatRect &region, std::vector<EntityId> &out) const
+    {
+        forEachInRegion(region, [&](const Entry &entry)
+                        {
+                            if (overlaps(entry.bounds, region))
+                            {
+                                out.push_back(entry.id);
+                            } });
+    }
+
+    void SpatialIndex::queryPoint(sf::Vector2f point, std::vector<EntityId> &out) const
+    {
+        queryRegion(sf::FloatRect(point.x, point.y, 0.0f, 0.0f), out);
+    }
+
+    void SpatialIndex::queryRadius(sf::Vector2f center, float radius, std::vector<EntityId> &out) const
+    {
+        sf::FloatRect region(center.x - radius, center.y - radius, radius * 2.0f, radius * 2.0f);
+        float radiusSquared = radius * radius;
+        forEachInRegion(region, [&](const Entry &entry)
+                        {
+                            if (distanceSquared(entry.bounds, center) <= radiusSquared)
+                            {
+                                out.push_back(entry.id);
+                            } });
+    }
+
+    EntityId SpatialIndex::queryNearest(sf::Vector2f point, float maxDistance, EntityId ignore) const
+    {
+        EntityId nearest;
+        if (m_count == 0)
+        {
+            return nearest;
+        }
+
+        float bestSquared = maxDistance * maxDistance;
+        auto visitEntry = [&](const Entry &entry)
+        {
+            float squared = distanceSquared(entry.bounds, point);
+            if (squared <= bestSquared && !(entry.id == ignore))
+            {
+                bestSquared = squared;
+                nearest = entry.id;
+            }
+        };
+
+        for (std::uint32_t index : m_oversized)
+        {
+            visitEntry(m_entries[index]);
+        }
+        if (!hasOccupiedCells())
+        {
+            return nearest;
+        }
+
+        auto visitCell = [&](std::int32_t x, std::int32_t y)
+        {
+            if (x < m_minCell[0] || x > m_maxCell[0] || y < m_minCell[1] || y > m_maxCell[1])
+            {
+                return;
+            }
+
+            auto it = m_cells.find(keyOf(x, y));
+            if (it == m_cells.end())
+            {
+                return;
+            }
+
+            for (std::uint32_t index : it->second)
+            {
+                visitEntry(m_entries[index]);
+            }
+        };
+
+        std::int32_t centerX = cellOf(point.x), centerY = cellOf(point.y);
+
+        // Past this ring every occupied cell was visited
+        std::int64_t lastRing = std::max({std::int64_t(centerX) - m_minCell[0], std::int64_t(m_maxCell[0]) - centerX,
+                                          std::int64_t(centerY) - m_minCell[1], std::int64_t(m_maxCell[1]) - centerY});
+
+        for (std::int64_t ring = 0; ring <= lastRing; ring++)
+        {
+            // Whatever lies outside the rings visited so far is at least this far from the point
+            float reached = float(ring - 1) * m_cellSize;
+            if (ring > 0 && reached * reached > bestSquared)
+            {
+                break;
+            }
+
+            std::int64_t x0 = centerX - ring, x1 = centerX + ring;
+            std::int64_t y0 = centerY - ring, y1 = centerY + ring;
+            for (std::int64_t x = std::max<std::int64_t>(x0, m_minCell[0]); x <= std::min<std::int64_t>(x1, m_maxCell[0]); x++)
+            {
+                visitCell(std::int32_t(x), std::int32_t(y0));
+                if (y1 != y0)
+                {
+                    visitCell(std::int32_t(x), std::int32_t(y1));
+                }
+            }
+            for (std::int64_t y = std::max<std::int64_t>(y0 + 1, m_minCell[1]); y <= std::min<std::int64_t>(y1 - 1, m_maxCell[1]); y++)
+            {
+                visitCell(std::int32_t(x0), std::int32_t(y));
+                visitCell(std::int32_t(x1), std::int32_t(y));
+            }
+        }
+
+        return nearest;
+    }
+
+    void SpatialIndex::queryRay(sf::Vector2f origin, sf::Vector2f direction, float maxDistance, std::vector<EntityId> &out) const
+    {
+        float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+        if (m_count == 0 || length == 0.0f)
+        {
+            return;
+        }
+        direction /= length;
+
+        std::vector<std::pair<float, std::uint32_t>> hits;
+        auto hitEntry = [&](std::uint32_t index)
+        {
+            float tMin = 0.0f, tMax = maxDistance;
+            if (clipRay(m_entries[index].bounds, origin, direction, tMin, tMax))
+            {
+                hits.emplace_back(tMin, index);
+            }
+        };
+
+        for (std::uint32_t index : m_oversized)
+        {
+            hitEntry(index);
+        }
+
+        // Only the part of the ray over occupied cells is walked
+        sf::FloatRect occupied(m_minCell[0] * m_cellSize, m_minCell[1] * m_cellSize,
+                               (m_maxCell[0] - m_minCell[0] + 1) * m_cellSize, (m_maxCell[1] - m_minCell[1] + 1) * m_cellSize);
+        float tStart = 0.0f, tEnd = maxDistance;
+        if (hasOccupiedCells() && clipRay(occupied, origin, direction, tStart, tEnd))
+        {
+            walkRay(origin, direction, tStart, tEnd, hitEntry);
+        }
+
+        // The same entity is hit from every cell it spans, always at the same distance
+        std::sort(hits.begin(), hits.end());
+        hits.erase(std::unique(hits.begin(), hits.end()), hits.end());
+        for (auto &[distance, index] : hits)
+        {
+            out.push_back(m_entries[index].id);
+        }
+    }
+} // namespace wpwp
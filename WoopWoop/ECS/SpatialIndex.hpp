@@ -0,0 +1,178 @@
+#ifndef SPATIAL_INDEX_HPP
+#define SPATIAL_INDEX_HPP
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include "EntityId.hpp"
+
+namespace wpwp
+{
+    /**
+     * @brief Hashed uniform grid over the bounds of every instantiated entity with a transform.
+     *
+     * An entity's bounds are the box of its world scale centered on its world position, grown to fit its z rotation.
+     * The index is brought up to date once per frame by refresh(), which only visits the entities moved or created since the last refresh,
+     * so queries see the transforms as they were at the start of the frame.
+     * Destroyed entities are dropped at the next sync point (see Entity::onEntitiesDestroyed), until then queries may still name them.
+     * Entities spanning more than MAX_CELL_SPAN cells on an axis aren't inserted in the grid but kept in a list every query checks,
+     * so a huge entity costs one entry instead of one per cell.
+     * Queries don't modify the index and can run from several threads at once, refresh() can't run alongside them.
+     */
+    class SpatialIndex
+    {
+    public:
+        static constexpr std::int32_t MAX_CELL_SPAN = 16; // Most cells an entity is inserted in along each axis.
+
+        /**
+         * @brief Gets the singleton instance of the spatial index.
+         *
+         * @return Reference to the spatial index.
+         */
+        static SpatialIndex &getInstance();
+
+        /**
+         * @brief Reinserts the entities whose transform changed since the last refresh, and inserts the newly instantiated ones.
+         * Only the moved (see Transform::takeMoved()) and created entities are visited, the others cost nothing.
+         * Must be called from the thread running the simulation after Transform::propagateChanges().
+         */
+        void refresh();
+
+        /**
+         * @brief Removes every entity, the index is rebuilt on the next refresh.
+         */
+        void clear();
+
+        /**
+         * @brief Removes every entity and changes the size of the grid's cells.
+         * Best set around the size of a typical entity, the index is rebuilt on the next refresh.
+         *
+         * @param cellSize The width and height of a cell, in world units.
+         */
+        void setCellSize(float cellSize);
+
+        float getCellSize() const { return m_cellSize; }
+
+        /**
+         * @brief Gets the amount of indexed entities.
+         *
+         * @return The indexed entity count.
+         */
+        std::size_t size() const { return m_count; }
+
+        /**
+         * @brief Gets the indexed bounds of an entity.
+         *
+         * @param id The id of the entity.
+         * @param bounds Receives the bounds if the entity is indexed.
+         * @return True if the entity is indexed.
+         */
+        bool getBounds(EntityId id, sf::FloatRect &bounds) const;
+
+        /**
+         * @brief Finds the entities whose bounds overlap a rectangle.
+         *
+         * @param region The rectangle, in world units.
+         * @param out Receives the ids of the entities, appended in no particular order.
+         */
+        void queryRegion(const sf::FloatRect &region, std::vector<EntityId> &out) const;
+
+        /**
+         * @brief Finds the entities whose bounds contain a point.
+         *
+         * @param point The point, in world units.
+         * @param out Receives the ids of the entities, appended in no particular order.
+         */
+        void queryPoint(sf::Vector2f point, std::vector<EntityId> &out) const;
+
+        /**
+         * @brief Finds the entities whose bounds are within a distance of a point.
+         *
+         * @param center The point, in world units.
+         * @param radius The distance from the point.
+         * @param out Receives the ids of the entities, appended in no particular order.
+         */
+        void queryRadius(sf::Vector2f center, float radius, std::vector<EntityId> &out) const;
+
+        /**
+         * @brief Finds the entity whose bounds are the closest to a point, searching the grid in growing rings of cells.
+         *
+         * @param point The point, in world units.
+         * @param maxDistance The farthest distance to search up to.
+         * @param ignore An entity to skip, usually the one searching.
+         * @return The id of the closest entity, invalid if none is within maxDistance.
+         */
+        EntityId queryNearest(sf::Vector2f point, float maxDistance, EntityId ignore = EntityId()) const;
+
+        /**
+         * @brief Finds the entities whose bounds a ray hits, walking the cells along the ray.
+         *
+         * @param origin The start of the ray, in world units.
+         * @param direction The direction of the ray, doesn't have to be normalized.
+         * @param maxDistance The length of the ray.
+         * @param out Receives the ids of the entities, appended closest first.
+         */
+        void queryRay(sf::Vector2f origin, sf::Vector2f direction, float maxDistance, std::vector<EntityId> &out) const;
+
+    private:
+        /// @brief Private constructor to enforce singleton pattern.
+        SpatialIndex();
+
+        /**
+         * @brief Bounds of an indexed entity and the cells it was inserted in.
+         */
+        struct Entry
+        {
+            EntityId id;                       // Id of the entity, invalid for free slots.
+            sf::FloatRect bounds;              // Bounds of the entity when it was inserted.
+            std::int32_t minX = 0, minY = 0;   // First cell covered by the bounds.
+            std::int32_t maxX = -1, maxY = -1; // Last cell covered by the bounds.
+            bool oversized = false;            // Whether the entry is in the oversized list instead of the cells.
+        };
+
+        void insert(EntityId id, const sf::FloatRect &bounds);
+        void remove(EntityId id);
+
+        /**
+         * @brief Inserts an entity again at its current bounds, if it is still instantiated.
+         */
+        void reinsert(EntityId id);
+
+        /**
+         * @brief Checks if any entity was inserted in the cells since the last clear.
+         */
+        bool hasOccupiedCells() const { return m_maxCell[0] >= m_minCell[0]; }
+
+        std::int32_t cellOf(float coordinate) const;
+        static std::uint64_t keyOf(std::int32_t x, std::int32_t y);
+
+        /**
+         * @brief Calls func with the entry index of every entity inserted in the cells a rectangle covers, once per entity.
+         */
+        template <typename Func>
+        void forEachInRegion(const sf::FloatRect &region, Func func) const;
+
+        /**
+         * @brief Calls func with the entry index of every entity inserted in the cells a ray crosses between tStart and tEnd, once per cell.
+         */
+        template <typename Func>
+        void walkRay(sf::Vector2f origin, sf::Vector2f direction, float tStart, float tEnd, Func func) const;
+
+    private:
+        float m_cellSize = 128.0f;                                             // Width and height of a cell, in world units.
+        std::unordered_map<std::uint64_t, std::vector<std::uint32_t>> m_cells; // Entry indices of the entities overlapping each non-empty cell.
+        std::vector<Entry> m_entries;                                          // Indexed entities, by entity id index.
+        std::vector<std::uint32_t> m_oversized;                                // Entry indices of the entities spanning too many cells.
+        std::size_t m_count = 0;                                               // Amount of indexed entities.
+        std::int32_t m_minCell[2] = {0, 0};                                    // Lowest cell occupied since the last clear, bounds the nearest search.
+        std::int32_t m_maxCell[2] = {-1, -1};                                  // Highest cell occupied since the last clear.
+        std::vector<EntityId> m_created;                                       // Entities created since the last refresh.
+        std::vector<EntityId> m_moved;                                         // Scratch buffer of the entities moved since the last refresh.
+        bool m_rebuild = true;                                                 // Whether the next refresh inserts every entity.
+    };
+} // namespace wpwp
+
+#endif // SPATIAL_INDEX_HPP
@@ -0,0 +1,123 @@
+#include "System.hpp"
+#include "Component.hpp"
+#include "Util/ThreadPool.hpp"
+#include <algorithm>
+
+namespace wpwp
+{
+    bool System::conflictsWith(const System &other) const
+    {
+        return (m_writes & (other.m_reads | other.m_writes)).any() ||
+               (other.m_writes & m_reads).any();
+    }
+
+    bool System::hasChanged(const Component &component) const
+    {
+        return component.changedSince(m_lastRunTick);
+    }
+
+    void SystemScheduler::addSystem(System &system)
+    {
+        m_systems.push_back(&system);
+        m_dirty = true;
+    }
+
+    void SystemScheduler::removeSystem(System &system)
+    {
+        m_systems.erase(std::remove(m_systems.begin(), m_systems.end(), &system), m_systems.end());
+        m_dirty = true;
+    }
+
+    void SystemScheduler::buildGraph()
+    {
+        m_nodes.clear();
+        for (System *system : m_systems)
+        {
+            m_nodes.push_back(Node{system, {}, 0});
+        }
+
+        for (std::size_t later = 0; later < m_nodes.size(); later++)
+        {
+            for (std::size_t earlier = 0; earlier < later; earlier++)
+            {
+                if (m_nodes[earlier].system->conflictsWith(*m_nodes[later].system))
+                {
+                    m_nodes[earlier].dependents.push_back(later);
+                    m_nodes[later].dependencyCount++;
+                }
+            }
+        }
+
+        m_waiting = std::make_unique<std::atomic<std::size_t>[]>(m_nodes.size());
+        m_dirty = false;
+    }
+
+    void SystemScheduler::run(float deltaTime)
+    {
+        if (m_dirty)
+        {
+            buildGraph();
+        }
+
+        if (m_nodes.empty())
+        {
+            return;
+        }
+
+        m_deltaTime = deltaTime;
+        m_unfinished = m_nodes.size();
+        for (std::size_t i = 0; i < m_nodes.size(); i++)
+        {
+            m_waiting[i] = m_nodes[i].dependencyCount;
+        }
+
+        ThreadPool &pool = ThreadPool::getInstance();
+        for (std::size_t i = 0; i < m_nodes.size(); i++)
+        {
+            if (m_nodes[i].dependencyCount == 0)
+            {
+                pool.submit([this, i]()
+                            { runNode(i); });
+            }
+        }
+
+        // Help with the work instead of idling, sleep only once nothing is left to pick up
+        while (m_unfinished > 0)
+        {
+            if (!pool.runPendingTask())
+            {
+                std::unique_lock<std::mutex> lock(m_doneMutex);
+                m_done.wait(lock, [this]()
+                            { return m_unfinished == 0; });
+            }
+        }
+    }
+
+    void SystemScheduler::runNode(std::size_t index)
+    {
+        Node &node = m_nodes[index];
+        if (node.system->isEnabled)
+        {
+            node.system->update(m_deltaTime);
+
+            // Systems conflicting with this one are ordered around it, so nothing it reads changes while it runs
+            node.system->m_lastRunTick = ChangeTicks::observe();
+        }
+
+        ThreadPool &pool = ThreadPool::getInstance();
+        for (std::size_t dependent : node.dependents)
+        {
+            if (--m_waiting[dependent] == 0)
+            {
+                pool.submit([this, dependent]()
+                            { runNode(dependent); });
+            }
+        }
+
+        if (--m_unfinished == 0)
+        {
+            std::lock_guard<std::mutex> lock(m_doneMutex);
+            m_done.notify_all();
+        }
+    }
+} // namespace wpwp
@@ -0,0 +1,161 @@
+#ifndef SYSTEM_HPP
+#define SYSTEM_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ChangeTick.hpp"
+#include "ComponentType.hpp"
+
+namespace wpwp
+{
+    struct Component;
+
+    /**
+     * @brief Base class for systems, per frame logic that works on component data instead of living inside a component.
+     *
+     * A system declares the component types it reads and writes in its constructor,
+     * systems whose declarations don't conflict are run at the same time on the thread pool.
+     * Systems must not add or remove components or entities while they run, they record them in Engine::getCommandBuffer() instead.
+     */
+    class System
+    {
+    public:
+        virtual ~System() = default;
+
+        /**
+         * @brief Runs the system for one frame.
+         *
+         * @param deltaTime Time since the last frame, in seconds.
+         */
+        virtual void update(float deltaTime) = 0;
+
+        /**
+         * @brief Gets the name of the system.
+         *
+         * @return The name of the system.
+         */
+        virtual std::string getName() const { return "System"; }
+
+        /**
+         * @brief Checks if the two systems can't run at the same time,
+         * that is if one of them writes a type the other one reads or writes.
+         *
+         * @param other The system to check against.
+         * @return True if the systems conflict.
+         */
+        bool conflictsWith(const System &other) const;
+
+        const ComponentMask &getReads() const { return m_reads; }
+        const ComponentMask &getWrites() const { return m_writes; }
+
+        bool isEnabled = true; // Flag indicating whether the system is updated.
+
+    protected:
+        /**
+         * @brief Checks if a component changed since the previous run of the system ended,
+         * changes the system made itself during that run don't count.
+         *
+         * @param component The component to check.
+         * @return True if the component changed since the system last ran.
+         */
+        bool hasChanged(const Component &component) const;
+
+        /**
+         * @brief Gets the tick the previous run of the system ended at, 0 before the first run.
+         *
+         * @return The tick to compare against with Component::changedSince.
+         */
+        Tick getLastRunTick() const { return m_lastRunTick; }
+
+        /**
+         * @brief Declares component types the system only reads.
+         */
+        template <typename... Ts>
+        void reads()
+        {
+            (m_reads.set(ComponentTypes::get<Ts>()), ...);
+        }
+
+        /**
+         * @brief Declares component types the system modifies.
+         */
+        template <typename... Ts>
+        void writes()
+        {
+            (m_writes.set(ComponentTypes::get<Ts>()), ...);
+        }
+
+    private:
+        ComponentMask m_reads;  // Types the system reads.
+        ComponentMask m_writes; // Types the system writes.
+        Tick m_lastRunTick = 0; // Tick the previous run ended at.
+
+        friend class SystemScheduler;
+    };
+
+    /**
+     * @brief Runs systems on the thread pool, ordered by their declared reads and writes.
+     *
+     * When two systems conflict the one added first runs first, everything else is free to run in parallel.
+     * The dependency graph is rebuilt only when systems are added or removed.
+     */
+    class SystemScheduler
+    {
+    public:
+        /**
+         * @brief Adds a system to the schedule, after the systems already added.
+         *
+         * @param system Reference to the system, must outlive the scheduler or be removed first.
+         */
+        void addSystem(System &system);
+
+        /**
+         * @brief Removes a system from the schedule.
+         *
+         * @param system Reference to the system to remove.
+         */
+        void removeSystem(System &system);
+
+        /**
+         * @brief Runs every enabled system once and waits for all of them to finish.
+         *
+         * @param deltaTime Time since the last frame, in seconds.
+         */
+        void run(float deltaTime);
+
+    private:
+        /**
+         * @brief Node of the dependency graph.
+         */
+        struct Node
+        {
+            System *system;                      // The system to run.
+            std::vector<std::size_t> dependents; // Nodes that have to wait for this one.
+            std::size_t dependencyCount = 0;     // Nodes this one has to wait for.
+        };
+
+        void buildGraph();
+
+        /**
+         * @brief Runs a node and queues the dependents it was the last dependency of.
+         */
+        void runNode(std::size_t index);
+
+    private:
+        std::vector<System *> m_systems;                       // Systems in the order they were added.
+        std::vector<Node> m_nodes;                             // Dependency graph of m_systems.
+        std::unique_ptr<std::atomic<std::size_t>[]> m_waiting; // Unfinished dependencies of each node in the current run.
+        bool m_dirty = false;                                  // Flag indicating whether the graph has to be rebuilt.
+
+        float m_deltaTime = 0.0f;                 // Delta time of the current run.
+        std::atomic<std::size_t> m_unfinished{0}; // Nodes left in the current run.
+        std::mutex m_doneMutex;                   // Guards waiting on m_done.
+        std::condition_variable m_done;           // Signaled when the last node of a run finishes.
+    };
+} // namespace wpwp
+
+#endif // SYSTEM_HPP
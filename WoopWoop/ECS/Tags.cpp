@@ -0,0 +1,63 @@
+#include "Tags.hpp"
+#include "Subsystems/Logging.hpp"
+#include <algorithm>
+#include <bit>
+
+namespace wpwp
+{
+    namespace
+    {
+        // Function local so tags can be assigned during static initialization
+        std::vector<std::string> &getTable()
+        {
+            static std::vector<std::string> names;
+            return names;
+        }
+    }
+
+    TagMask Tags::get(std::string_view name)
+    {
+        if (TagMask tag = find(name))
+        {
+            return tag;
+        }
+
+        std::vector<std::string> &names = getTable();
+        if (names.size() >= MAX_TAGS)
+        {
+            ERROR("Too many tags, can't add ", name, " (", MAX_TAGS, " at most)");
+            return 0;
+        }
+
+        names.emplace_back(name);
+        return TagMask(1) << (names.size() - 1);
+    }
+
+    TagMask Tags::find(std::string_view name)
+    {
+        const std::vector<std::string> &names = getTable();
+        auto it = std::find(names.begin(), names.end(), name);
+        return it != names.end() ? TagMask(1) << (it - names.begin()) : 0;
+    }
+
+    std::vector<std::string> Tags::getNames(TagMask tags)
+    {
+        const std::vector<std::string> &names = getTable();
+        std::vector<std::string> result;
+        while (tags)
+        {
+            std::size_t bit = std::countr_zero(tags);
+            if (bit < names.size())
+            {
+                result.push_back(names[bit]);
+            }
+            tags &= tags - 1;
+        }
+        return result;
+    }
+
+    const std::vector<std::string> &Tags::getAll()
+    {
+        return getTable();
+    }
+} // namespace wpwp
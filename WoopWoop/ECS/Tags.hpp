@@ -0,0 +1,88 @@
+#ifndef TAGS_HPP
+#define TAGS_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace wpwp
+{
+    /**
+     * @brief Set of tags, one bit per tag name.
+     */
+    using TagMask = std::uint64_t;
+
+    /**
+     * @brief Render and physics layer of an entity.
+     */
+    using Layer = std::uint8_t;
+
+    /**
+     * @brief Set of layers, one bit per layer, the same bits Box2D filters collisions with.
+     */
+    using LayerMask = std::uint16_t;
+
+    /**
+     * @brief Maximum amount of distinct tag names.
+     */
+    constexpr std::size_t MAX_TAGS = 64;
+
+    /**
+     * @brief Amount of layers, bounded by Box2D's 16 collision categories.
+     */
+    constexpr std::size_t MAX_LAYERS = 16;
+
+    /**
+     * @brief Every layer, the default of every layer filter.
+     */
+    constexpr LayerMask ALL_LAYERS = static_cast<LayerMask>(~LayerMask(0));
+
+    /**
+     * @brief Gets the bit of a layer in a LayerMask.
+     *
+     * @param layer The layer.
+     * @return The mask with only that layer set.
+     */
+    constexpr LayerMask layerBit(Layer layer) { return static_cast<LayerMask>(LayerMask(1) << layer); }
+
+    /**
+     * @brief Hands out a bit to every tag name, so entities can be filtered on tags with a single AND.
+     */
+    class Tags
+    {
+    public:
+        /**
+         * @brief Gets the bit of a tag, assigning one on first use.
+         *
+         * @param name The name of the tag, e.g. "Enemy".
+         * @return The mask with only the tag set, 0 if every bit is taken.
+         */
+        static TagMask get(std::string_view name);
+
+        /**
+         * @brief Gets the bit of a tag without assigning one.
+         *
+         * @param name The name of the tag.
+         * @return The mask with only the tag set, 0 if the tag was never used.
+         */
+        static TagMask find(std::string_view name);
+
+        /**
+         * @brief Gets the names of the tags in a mask.
+         *
+         * @param tags The mask.
+         * @return The names, in bit order.
+         */
+        static std::vector<std::string> getNames(TagMask tags);
+
+        /**
+         * @brief Gets the name of every tag assigned so far, by bit.
+         *
+         * @return The names, the tag at index i has bit i.
+         */
+        static const std::vector<std::string> &getAll();
+    };
+} // namespace wpwp
+
+#endif // TAGS_HPP
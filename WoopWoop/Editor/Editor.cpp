@@ -12,14 +12,24 @@ namespace wpwp::Editor
     {
 #ifdef DEBUG
 
-        Entity::onEntityInstantiated += [&](std::shared_ptr<Entity> e)
+        Entity::onEntitiesCreated += [&](std::span<const EntityId> ids)
         {
-            m_names.emplace_back(e->getName());
+            m_entities.insert(m_entities.end(), ids.begin(), ids.end());
         };
 
-        Entity::onEntityDestroyed += [&](std::shared_ptr<Entity> e)
+        // One pass over the hierarchy for the whole batch, instead of one per destroyed entity
+        Entity::onEntitiesDestroyed += [&](std::span<const EntityId> ids)
         {
-            m_names.erase(std::remove(m_names.begin(), m_names.end(), e->getName()), m_names.end());
+            std::unordered_set<EntityId> destroyed(ids.begin(), ids.end());
+            m_entities.erase(std::remove_if(m_entities.begin(), m_entities.end(), [&](EntityId id)
+                                            { return destroyed.count(id) != 0; }),
+                             m_entities.end());
+        };
+
+        Entity::onAllEntitiesDestroyed += [&]()
+        {
+            m_entities.clear();
+            m_selectedEntity = EntityId();
         };
 #endif
 #ifndef DEBUG
@@ -77,25 +87,17 @@ namespace wpwp::Editor
             ImGui::SetWindowSize(ImVec2(219, 675));
 
             bool canOpenPopUp = true;
-            std::unordered_set<std::string> namesToIgnore; // Using unordered_set for faster lookups
 
-            for (int i = 0; i < m_names.size(); ++i)
+            // Children are drawn under their parent
+            for (EntityId id : m_entities)
             {
-                if (namesToIgnore.find(m_names[i]) != namesToIgnore.end())
+                Entity *entity = Entity::get(id);
+                if (entity && Entity::isValid(entity->transform->getParent()))
                 {
                     continue;
                 }
 
-                auto children = Entity::getEntityWithName(m_names[i])->transform->getChildren();
-                if (!children.empty())
-                {
-                    for (auto child : children)
-                    {
-                        namesToIgnore.insert(child->getName());
-                    }
-                }
-
-                handleEntityTreeSelectionDrawing(i, canOpenPopUp);
+                handleEntityTreeSelectionDrawing(id, canOpenPopUp);
             }
 
             bool clickedOnBlankSpace = ImGui::IsWindowFocused() &&
@@ -122,11 +124,10 @@ namespace wpwp::Editor
             ImGui::SetWindowPos(ImVec2(1540, INITIAL_HEIGHT));
             ImGui::SetWindowSize(ImVec2(370, 975));
 
-            if (m_selectedEntity)
+            if (Entity *selectedEntity = Entity::get(m_selectedEntity))
             {
                 ImGui::SetWindowFontScale(1.3);
-                const char *name = m_names[m_selectedNameIndex].c_str();
-                std::string text = "Name: " + std::string(name);
+                std::string text = "Name: " + selectedEntity->getName();
                 ImGui::Text("%s", text.c_str());
 
                 float windowWidth = ImGui::GetWindowWidth();
@@ -142,48 +143,67 @@ namespace wpwp::Editor
                 }
 
                 ImGui::SameLine();
-                bool entityEnabled = m_selectedEntity->getEnabled();
+                bool entityEnabled = selectedEntity->getEnabled();
                 if (ImGui::Checkbox("##Enabled", &entityEnabled))
                 {
-                    m_selectedEntity->setEnabled(entityEnabled);
+                    selectedEntity->setEnabled(entityEnabled);
                 }
 
                 // if (ImGui::InputText("Name: ", name, size_t(255)))
                 // {
                 //     if (!Entity::getEntityWithName(name))
                 //     {
-                //         m_selectedEntity->setName(name);
-                //         m_names[m_selectedNameIndex] = name;
+                //         selectedEntity->setName(name);
                 //     }
                 // }
 
+                int layer = selectedEntity->getLayer();
+                if (ImGui::SliderInt("Layer", &layer, 0, MAX_LAYERS - 1))
+                {
+                    selectedEntity->setLayer(static_cast<Layer>(layer));
+                }
+
+                const std::vector<std::string> &tagNames = Tags::getAll();
+                for (std::size_t i = 0; i < tagNames.size(); i++)
+                {
+                    TagMask tag = TagMask(1) << i;
+                    bool hasTag = selectedEntity->hasTags(tag);
+                    if (ImGui::Checkbox(tagNames[i].c_str(), &hasTag))
+                    {
+                        hasTag ? selectedEntity->addTags(tag) : selectedEntity->removeTags(tag);
+                    }
+                }
+
                 ImGui::Separator();
-                m_components = m_selectedEntity->getComponents();
 
-                std::vector<std::string> componentsToRemove{};
-                for (auto &comp : m_components)
+                // Names are the interned ones of the types, the components themselves are never asked for theirs
+                const Registry &registry = Registry::getInstance();
+                const ComponentTypeId transformType = ComponentTypes::get<Transform>();
+                std::vector<ComponentTypeId> componentsToRemove{};
+                std::size_t column = 0;
+                for (Component &component : selectedEntity->getComponents())
                 {
-                    if (!comp)
-                        continue;
+                    Component *comp = &component;
+                    const ComponentTypeId type = selectedEntity->m_archetype->getTypes()[column++];
+                    const std::string &compName = registry.getString(registry.getTypeName(type));
 
                     ImGui::SetWindowFontScale(1.2);
-                    if (ImGui::TreeNodeEx(comp->getName().c_str()))
+                    if (ImGui::TreeNodeEx(compName.c_str()))
                     {
-                        if (comp->getName() != "Transform")
+                        if (type != transformType)
                         {
                             // BUG: For some reason removing any component crashes everything
-                            if (comp->getName() != "Transform" && ImGui::IsItemClicked(1))
+                            if (ImGui::IsItemClicked(1))
                             {
                                 ImGui::OpenPopup("Remove Component");
                             }
 
                             if (ImGui::BeginPopupContextItem("Remove Component"))
                             {
-                                if (comp->getName() != "Transform")
-                                    if (ImGui::MenuItem(std::string("Remove " + (comp->getName()) + " Component").c_str()))
-                                    {
-                                        componentsToRemove.push_back(comp->getName());
-                                    }
+                                if (ImGui::MenuItem(("Remove " + compName + " Component").c_str()))
+                                {
+                                    componentsToRemove.push_back(type);
+                                }
                                 ImGui::EndPopup();
                             }
                         }
@@ -206,27 +226,22 @@ namespace wpwp::Editor
 
                 if (ImGui::BeginPopup("Add Component Popup"))
                 {
-                    for (auto compName : Registry::getInstance().getAllRegistered())
+                    for (const std::string &compName : Registry::getInstance().getAllRegistered())
                     {
                         if (compName == "Transform")
                             continue;
 
                         if (ImGui::MenuItem(compName.c_str()))
                         {
-                            m_selectedEntity->addComponent(Registry::getInstance().createInstance(compName));
+                            selectedEntity->addComponent(Registry::getInstance().createInstance(compName));
                         }
                     }
                     ImGui::EndPopup();
                 }
 
-                // for (auto name : componentsToRemove)
+                // for (ComponentTypeId type : componentsToRemove)
                 // {
-                //     auto comp = m_selectedEntity->getComponent(name);
-                //     if (comp)
-                //     {
-                //         m_selectedEntity->removeComponent(comp);
-                //         m_components = m_selectedEntity->getComponents();
-                //     }
+                //     ArchetypeStorage::getInstance().removeComponent(*selectedEntity, type);
                 // }
             }
             ImGui::End();
@@ -248,6 +263,12 @@ namespace wpwp::Editor
                 sf::Vector2u textureSize = sprite.getTexture()->getSize();
                 ImGui::Image(Engine::getInstance()->m_renderTexture, scaleFactor, sf::Color::White, sf::Color::White);
                 Input::mouseOffset = sf::Vector2i(ImGui::GetWindowPos().x + 164, ImGui::GetWindowPos().y + 49);
+
+                if (ImGui::IsItemClicked(ImGuiMouseButton_Left))
+                {
+                    sf::Vector2i mousePos = Input::getMouseWorldPosition();
+                    pickEntity(sf::Vector2f(mousePos.x, mousePos.y));
+                }
                 ImGui::EndTabItem();
             }
 
@@ -258,14 +279,6 @@ namespace wpwp::Editor
             }
             ImGui::EndTabBar();
             ImGui::End();
-
-            if (m_selectedEntity)
-            {
-                m_components = m_selectedEntity->getComponents();
-
-                m_componentNames = VectorUtil::select(m_components, [](std::shared_ptr<Component> c)
-                                                      { return c->getName(); });
-            }
         }
 #pragma endregion Debug Screen
 
@@ -303,8 +316,7 @@ namespace wpwp::Editor
                     {
                         if (ImGui::MenuItem("Clear"))
                         {
-                            Logging::s_logs.clear();
-                            Logging::s_logMapCount.clear();
+                            Logging::clear();
                         }
                         ImGui::EndPopup();
                     }
@@ -347,26 +359,57 @@ namespace wpwp::Editor
 #endif
     }
 
-    void Editor::selectEntity(int index)
+    void Editor::selectEntity(EntityId id)
     {
 #ifdef DEBUG
-        m_selectedNameIndex = index;
-        m_selectedEntity = Entity::getEntityWithName(m_names[m_selectedNameIndex]);
+        Entity *entity = Entity::get(id);
+        if (!entity)
+        {
+            return;
+        }
+
+        m_selectedEntity = id;
+#endif
+    }
 
-        m_componentNames = VectorUtil::select(m_selectedEntity->getComponents(), [](std::shared_ptr<Component> c)
-                                              { return c->getName(); });
+    void Editor::pickEntity(sf::Vector2f point)
+    {
+#ifdef DEBUG
+        std::vector<EntityId> hits;
+        SpatialIndex::getInstance().queryPoint(point, hits);
 
-        m_components = m_selectedEntity->getComponents();
+        // Overlapping entities are told apart by size, so a small one on top of a large one can still be picked
+        EntityId picked;
+        float pickedArea = 0.0f;
+        for (EntityId id : hits)
+        {
+            sf::FloatRect bounds;
+            if (SpatialIndex::getInstance().getBounds(id, bounds) && (picked.isNull() || bounds.width * bounds.height < pickedArea))
+            {
+                picked = id;
+                pickedArea = bounds.width * bounds.height;
+            }
+        }
+
+        if (!picked.isNull())
+        {
+            selectEntity(picked);
+        }
 #endif
     }
 
-    void Editor::handleEntityTreeSelectionDrawing(int i, bool &canOpenCreateEntityPopup)
+    void Editor::handleEntityTreeSelectionDrawing(EntityId id, bool &canOpenCreateEntityPopup)
     {
 #ifdef DEBUG
+        Entity *entity = Entity::get(id);
+        if (!entity)
+        {
+            return;
+        }
 
-        const bool isSelected = (m_selectedNameIndex == i);
+        const bool isSelected = (m_selectedEntity == id);
         ImVec4 col = ImVec4(1.0f, 1.0f, 1.0f, 1.0f); // White color by default
-        bool isEnabled = Entity::getEntityWithName(m_names[i])->getEnabled();
+        bool isEnabled = entity->getEnabled();
         if (isSelected)
         {
             col = ImVec4(0.0f, 1.0f, 0.0f, 1.0f); // Green color for selected item\
@@ -387,7 +430,7 @@ namespace wpwp::Editor
 
         ImGui::PushStyleColor(ImGuiCol_Text, col);
 
-        bool nodeOpen = ImGui::TreeNodeEx(m_names[i].c_str());
+        bool nodeOpen = ImGui::TreeNodeEx(entity->getName().c_str());
         if (isSelected)
         {
             ImGui::SetItemDefaultFocus();
@@ -401,24 +444,14 @@ namespace wpwp::Editor
 
         if (ImGui::IsItemClicked(ImGuiMouseButton_Left))
         {
-            selectEntity(i);
+            selectEntity(id);
         }
 
         if (nodeOpen)
         {
-            auto entity = Entity::getEntityWithName(m_names[i]);
-            if (entity)
+            for (EntityId child : entity->transform->getChildren())
             {
-                for (auto child : entity->transform->getChildren())
-                {
-                    for (int j = 0; j < m_names.size(); j++)
-                    {
-                        if (m_names[j] == child->getName())
-                        {
-                            handleEntityTreeSelectionDrawing(j, canOpenCreateEntityPopup);
-                        }
-                    }
-                }
+                handleEntityTreeSelectionDrawing(child, canOpenCreateEntityPopup);
             }
             ImGui::TreePop();
         }
@@ -26,28 +26,31 @@ namespace wpwp::Editor
         /// @brief Update the editor state.
         void editorUpdate();
 
-        /** @brief Select an entity by its index.
+        /** @brief Select an entity.
          *
-         * @param index The index of the entity to select.
+         * @param id The id of the entity to select.
          */
-        void selectEntity(int index);
+        void selectEntity(EntityId id);
+
+        /** @brief Select the smallest entity under a point of the world.
+         *
+         * @param point The point, in world units.
+         */
+        void pickEntity(sf::Vector2f point);
 
         /** @brief Handle the drawing of tree selection.
          *
-         * @param index The index of the selected entity.
+         * @param id The id of the entity to draw.
          */
-        void handleEntityTreeSelectionDrawing(int index, bool &canOpenPopup);
+        void handleEntityTreeSelectionDrawing(EntityId id, bool &canOpenPopup);
 
     private:
         bool m_editorActive = true; // Flag indicating whether the editor is active.
 
-        std::vector<std::string> m_names; // List of entity names.
+        std::vector<EntityId> m_entities; // List of instantiated entities, in instantiation order.
 
 #pragma region DEBUG_VALUES
-        int m_selectedNameIndex = -1;                         // Index of the selected entity name.
-        std::shared_ptr<Entity> m_selectedEntity = nullptr;   // Pointer to the selected entity.
-        std::vector<std::string> m_componentNames;            // List of component names.
-        std::vector<std::shared_ptr<Component>> m_components; // List of components.
+        EntityId m_selectedEntity; // Id of the selected entity.
 #pragma endregion
     };
 };
@@ -8,7 +8,7 @@
 #include "Serlization/SceneSerializer.hpp"
 #include "Engine.hpp"
 
-#include <unordered_set>
+#include <cstdio>
 #include <mutex>
 #include <iostream>
 
@@ -32,6 +32,14 @@ namespace wpwp
         init();
     }
 
+    Engine::Engine(Headless)
+    {
+        if (instance == nullptr)
+        {
+            instance = this;
+        }
+    }
+
     void Engine::init()
     {
         LOG("Initializing engine...");
@@ -149,24 +157,212 @@ namespace wpwp
 
         while (window.isOpen())
         {
+            sf::Clock frameClock;
+
+            // Also when switching back from pipelined mode, so a frame still simulating finishes first
+            waitForSimulation();
+            const float waited = frameClock.getElapsedTime().asSeconds();
+
+            // Only read while the simulation thread is idle, it's waited for above and handed the next frame below
+            float simulated = m_simulationTime;
+
             onStartOfFrame.invoke();
 
             drawFPSCounter();
 
-            updateSequence();
+            const bool simulateHere = !m_pipelined;
+            if (simulateHere)
+            {
+                simulate();
+                simulated = m_simulationTime;
+            }
+            applySyncPoint();
             checkForEvents();
             onStartRender.invoke();
 
+            // Drawn before the subsystems, the editor puts the render texture on the window from there
+            if (m_pipelined)
+            {
+                drawSnapshot();
+            }
+
             updateSubsystems();
+            const float synced = frameClock.getElapsedTime().asSeconds();
+
+            if (m_pipelined)
+            {
+                // Nothing but the simulation touches the world until the next wait
+                startSimulation();
+            }
 
             onEndOfFrame.invoke();
+
+            const float frame = frameClock.getElapsedTime().asSeconds();
+            m_frameTimings = FrameTimings{simulated, synced - waited - (simulateHere ? simulated : 0.0f), frame - synced, waited, frame};
         }
 
         shutdown();
     }
 
+    void Engine::step(float deltaTime)
+    {
+        Util::m_deltaTime = deltaTime;
+        simulate();
+        applySyncPoint();
+    }
+
+    void Engine::applySyncPoint()
+    {
+        m_commandBuffer.apply(); // Sync point, nothing is iterating the world here
+        Entity::flushLifecycleEvents();
+        DeferredSignals::flush(); // Transform changes of the frame, one notification per listener
+    }
+
+    void Engine::simulate()
+    {
+        sf::Clock clock;
+        fixedUpdateSequence();
+        updateSequence();
+        m_simulationTime = clock.getElapsedTime().asSeconds();
+    }
+
+    void Engine::startSimulation()
+    {
+        m_renderLists[m_recordingList].clear();
+
+        if (!m_updateThread.joinable())
+        {
+            m_updateThread = std::thread([this]()
+                                         { simulationLoop(); });
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_simulationMutex);
+            m_simulationPending = true;
+            m_frameInFlight = true;
+        }
+        m_simulationSignal.notify_all();
+    }
+
+    void Engine::waitForSimulation()
+    {
+        if (!m_updateThread.joinable())
+        {
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(m_simulationMutex);
+        if (!m_frameInFlight)
+        {
+            return;
+        }
+
+        m_simulationSignal.wait(lock, [this]()
+                                { return !m_simulationPending; });
+        m_frameInFlight = false;
+
+        // The finished frame becomes the one to draw, the simulation records the next one into the other list
+        m_recordingList = 1 - m_recordingList;
+    }
+
+    void Engine::simulationLoop()
+    {
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_simulationMutex);
+                m_simulationSignal.wait(lock, [this]()
+                                        { return m_simulationPending || m_stopSimulation; });
+                if (m_stopSimulation)
+                {
+                    return;
+                }
+            }
+
+            simulate();
+
+            {
+                std::lock_guard<std::mutex> lock(m_simulationMutex);
+                m_simulationPending = false;
+            }
+            m_simulationSignal.notify_all();
+        }
+    }
+
+    void Engine::drawSnapshot()
+    {
+        if (m_isPaused)
+        {
+            return;
+        }
+
+        m_renderTexture.clear();
+        draw(m_fpsText);
+        m_renderLists[1 - m_recordingList].draw(m_renderTexture);
+        m_renderTexture.display();
+    }
+
+    void Engine::submit(const sf::CircleShape &shape)
+    {
+        if (m_pipelined)
+        {
+            m_renderLists[m_recordingList].add(shape);
+        }
+        else
+        {
+            m_renderTexture.draw(shape);
+        }
+    }
+
+    void Engine::submit(const sf::RectangleShape &shape)
+    {
+        if (m_pipelined)
+        {
+            m_renderLists[m_recordingList].add(shape);
+        }
+        else
+        {
+            m_renderTexture.draw(shape);
+        }
+    }
+
+    void Engine::submit(const sf::Sprite &sprite, std::shared_ptr<const sf::Texture> texture)
+    {
+        if (m_pipelined)
+        {
+            m_renderLists[m_recordingList].add(sprite, std::move(texture));
+        }
+        else
+        {
+            m_renderTexture.draw(sprite);
+        }
+    }
+
+    void Engine::submitView(const sf::View &view)
+    {
+        if (m_pipelined)
+        {
+            m_renderLists[m_recordingList].setView(view);
+        }
+        else
+        {
+            m_renderTexture.setView(view);
+        }
+    }
+
     void Engine::shutdown()
     {
+        waitForSimulation();
+        if (m_updateThread.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_simulationMutex);
+                m_stopSimulation = true;
+            }
+            m_simulationSignal.notify_all();
+            m_updateThread.join();
+        }
+
         LOG("Shutting down engine...");
         for (auto &sub : m_subsystems)
         {
@@ -183,23 +379,119 @@ namespace wpwp
 
     void Engine::updateSequence()
     {
-        std::unordered_set<std::shared_ptr<Entity>> entitiesToIgnore{};
-        if (!m_isPaused)
+        // Also while paused, the editor can still move entities
+        Transform::propagateChanges();
+        SpatialIndex::getInstance().refresh();
+
+        if (m_isPaused)
         {
-            for (auto ent : wpwp::Entity::getAllEntities())
+            return;
+        }
+
+        updateComponents(false);
+        m_scheduler.run(Util::deltaTime());
+    }
+
+    void Engine::setTickRate(float ticksPerSecond)
+    {
+        if (ticksPerSecond <= 0)
+        {
+            ERROR("Tick rate must be positive, got ", ticksPerSecond);
+            return;
+        }
+        m_fixedDeltaTime = 1.0f / ticksPerSecond;
+    }
+
+    void Engine::fixedUpdateSequence()
+    {
+        if (m_isPaused)
+        {
+            // Resuming doesn't replay the paused time, and nothing moved to interpolate
+            m_accumulator = 0.0f;
+            m_interpolationAlpha = 1.0f;
+            return;
+        }
+
+        // Past the cap the time is dropped, catching up on it would only make the next frame slower still
+        const float frameTime = Util::deltaTime();
+        m_accumulator = std::min(m_accumulator + frameTime, m_fixedDeltaTime * m_maxStepsPerFrame);
+
+        Util::m_deltaTime = m_fixedDeltaTime;
+        while (m_accumulator >= m_fixedDeltaTime)
+        {
+            Transform::beginFixedStep();
+
+            updateComponents(true);
+            for (auto &sub : m_subsystems)
             {
-                if (entitiesToIgnore.find(ent) == entitiesToIgnore.end())
+                if (sub && sub->isEnabled)
                 {
-                    if (ent->getEnabled())
-                    {
-                        ent->update(0.0);
-                    }
+                    sub->fixedUpdate(m_fixedDeltaTime);
                 }
-                if (!ent->getEnabled())
+            }
+
+            // Descendants moved by the step are interpolated along with their parent
+            Transform::propagateChanges();
+            Transform::endFixedStep();
+
+            m_accumulator -= m_fixedDeltaTime;
+        }
+        Util::m_deltaTime = frameTime;
+
+        m_interpolationAlpha = m_accumulator / m_fixedDeltaTime;
+    }
+
+    void Engine::updateComponents(bool fixed)
+    {
+        auto &storage = ArchetypeStorage::getInstance();
+
+        // Which rows are active is worked out once per archetype, not once per component
+        const std::size_t archetypeCount = storage.getArchetypeCount();
+        if (m_activeRows.size() < archetypeCount)
+        {
+            m_activeRows.resize(archetypeCount);
+        }
+        for (std::size_t a = 0; a < archetypeCount; a++)
+        {
+            const auto &entities = storage.getArchetype(a).getEntities();
+            m_activeRows[a].assign(entities.size(), false);
+            for (std::size_t row = 0; row < entities.size(); row++)
+            {
+                Entity *ent = entities[row];
+                m_activeRows[a][row] = ent->isInstantiated() && ent->isActiveInHierarchy();
+            }
+        }
+
+        // Updated one component type at a time across every archetype, so the same update() runs back to back.
+        // Types keeping the empty Component::update() (or fixedUpdate()) are never visited
+        const std::size_t typeCount = ComponentTypes::count();
+        for (ComponentTypeId type = 0; type < typeCount; type++)
+        {
+            if (fixed ? !ComponentTypes::hasFixedUpdate(type) : !ComponentTypes::hasUpdate(type))
+            {
+                continue;
+            }
+
+            // Index based and sizes re-checked, updates may spawn or destroy entities mid-pass.
+            // Archetypes created during the pass have no active rows until the next frame
+            const auto &archetypes = storage.getArchetypesWith(type);
+            for (std::size_t i = 0; i < archetypes.size() && archetypes[i] < archetypeCount; i++)
+            {
+                Archetype &archetype = storage.getArchetype(archetypes[i]);
+                const std::vector<bool> &activeRows = m_activeRows[archetypes[i]];
+                auto &components = archetype.getColumn(archetype.getColumnIndex(type));
+                for (std::size_t row = 0; row < components.size() && row < activeRows.size(); row++)
                 {
-                    for (auto child : ent->transform->getChildren())
+                    if (activeRows[row] && components[row])
                     {
-                        entitiesToIgnore.insert(child);
+                        if (fixed)
+                        {
+                            components[row]->fixedUpdate();
+                        }
+                        else
+                        {
+                            components[row]->update();
+                        }
                     }
                 }
             }
@@ -210,10 +502,16 @@ namespace wpwp
     {
         sf::Time elapsedTime = m_clock.restart();
         float fps = 1.0f / elapsedTime.asSeconds();
-        m_fpsText.setString("FPS: " + std::to_string(static_cast<int>(fps)));
+
+        // The last frame's split shows how much of the simulation the present hides in pipelined mode
+        char text[128];
+        std::snprintf(text, sizeof(text), "FPS: %d\nsim %.1f ms  sync %.1f ms  present %.1f ms  wait %.1f ms", static_cast<int>(fps),
+                      m_frameTimings.simulation * 1000.0f, m_frameTimings.sync * 1000.0f, m_frameTimings.present * 1000.0f, m_frameTimings.wait * 1000.0f);
+        m_fpsText.setString(text);
         Util::m_deltaTime = elapsedTime.asSeconds();
 
-        if (!m_isPaused)
+        // Pipelined frames are drawn from their render list by drawSnapshot()
+        if (!m_isPaused && !m_pipelined)
         {
             m_renderTexture.clear();
             draw(m_fpsText);
@@ -242,6 +540,11 @@ namespace wpwp
         }
     }
 
+    void Engine::addSystem(System &system)
+    {
+        m_scheduler.addSystem(system);
+    }
+
     bool Engine::checkForValidRun()
     {
         if (!instance)
@@ -288,7 +591,17 @@ namespace wpwp
 
     void Engine::loadScene(std::string filePath)
     {
+        // The previous level goes away in one go, before the next one allocates anything
+        if (m_currentScene)
+        {
+            // Queued entities and components belong to the old level, they would keep its arena alive
+            m_commandBuffer.clear();
+            m_currentScene->unload();
+            delete m_currentScene;
+        }
+
         m_currentScene = new Scene();
+        m_currentScene->activate();
         SceneSerializer serializer(*m_currentScene);
         if (serializer.deserialize(filePath))
         {
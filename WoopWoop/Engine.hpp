@@ -5,6 +5,13 @@
 #include <string>
 #include "Util/Subsystem.hpp"
 #include "Util/Signal.hpp"
+#include "ECS/System.hpp"
+#include "ECS/CommandBuffer.hpp"
+#include "ECS/Tags.hpp"
+#include "RenderList.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
 #include <iostream>
 #include <memory>
@@ -34,6 +41,18 @@ namespace wpwp
          */
         Engine(const std::string &title);
 
+        /**
+         * @brief Tag selecting the constructor that doesn't open a window.
+         */
+        struct Headless
+        {
+        };
+
+        /**
+         * @brief Constructs an engine without a window or subsystems, whose frames are run with step(), for tests and tools.
+         */
+        explicit Engine(Headless);
+
         /**
          * @brief Initializes the engine.
          */
@@ -44,6 +63,14 @@ namespace wpwp
          */
         void run();
 
+        /**
+         * @brief Runs the world work of one frame on the calling thread: the fixed steps, the updates and systems, then the sync point.
+         * What run() does every frame minus the window, its events, the subsystems and the drawing.
+         *
+         * @param deltaTime The length of the frame, in seconds.
+         */
+        void step(float deltaTime);
+
         /**
          * @brief Draws the specified drawable object onto the screen.
          *
@@ -62,6 +89,120 @@ namespace wpwp
         void draw(const sf::Vertex *vertices, std::size_t vertexCount,
                   sf::PrimitiveType type, const sf::RenderStates &states = sf::RenderStates::Default);
 
+        /**
+         * @brief Draws a circle for the frame being simulated, recorded for the render thread in pipelined mode.
+         * Renderers use submit() instead of draw() so they work in both modes.
+         *
+         * @param shape The circle.
+         */
+        void submit(const sf::CircleShape &shape);
+
+        /**
+         * @brief Draws a rectangle for the frame being simulated, recorded for the render thread in pipelined mode.
+         *
+         * @param shape The rectangle.
+         */
+        void submit(const sf::RectangleShape &shape);
+
+        /**
+         * @brief Draws a sprite for the frame being simulated, recorded for the render thread in pipelined mode.
+         *
+         * @param sprite The sprite.
+         * @param texture The sprite's texture, kept alive until the frame is drawn.
+         */
+        void submit(const sf::Sprite &sprite, std::shared_ptr<const sf::Texture> texture);
+
+        /**
+         * @brief Sets the view of the frame being simulated, recorded for the render thread in pipelined mode.
+         *
+         * @param view The view the following submissions are drawn with.
+         */
+        void submitView(const sf::View &view);
+
+        /**
+         * @brief Sets whether the simulation of the next frame runs on its own thread while the main thread presents the current one.
+         *
+         * In pipelined mode update(), fixedUpdate() and the systems run on the simulation thread. Only onEndOfFrame, which presents
+         * the frame, overlaps the simulation. The sync point runs serially on the main thread once the simulation is done: the command
+         * buffer, the lifecycle events, the deferred signals, the window events, drawing the finished frame from its render list
+         * and the subsystems (editor, ImGui), so those are free to touch entities.
+         * A frame then takes about sync + max(simulation, present), see getFrameTimings() for the actual split.
+         * Components must only reach the screen through submit() and submitView(). What's shown is one frame behind the simulation.
+         *
+         * @param pipelined True for pipelined mode, false to run everything on the main thread.
+         */
+        void setPipelined(bool pipelined) { m_pipelined = pipelined; }
+
+        bool isPipelined() const { return m_pipelined; }
+
+        /**
+         * @brief Where the time of a frame went, in seconds.
+         */
+        struct FrameTimings
+        {
+            float simulation = 0.0f; // Fixed steps, updates and systems, of the frame handed to the simulation thread last in pipelined mode.
+            float sync = 0.0f;       // Serial work on the main thread: command buffer, lifecycle events, deferred signals, window events, drawing and subsystems.
+            float present = 0.0f;    // onEndOfFrame, the part overlapping the simulation in pipelined mode.
+            float wait = 0.0f;       // Main thread blocked on the simulation, what's left of it once the frame is presented.
+            float frame = 0.0f;      // The whole frame.
+        };
+
+        /**
+         * @brief Gets the timings of the last complete frame, measured by run().
+         *
+         * @return The timings.
+         */
+        const FrameTimings &getFrameTimings() const { return m_frameTimings; }
+
+        /**
+         * @brief Sets the layers renderers draw on, the main camera sets its culling mask every frame.
+         *
+         * @param layers The drawn layers.
+         */
+        void setRenderLayers(LayerMask layers) { m_renderLayers = layers; }
+
+        /**
+         * @brief Checks if renderers on a layer are drawn.
+         *
+         * @param layer The layer.
+         * @return True if the layer is drawn.
+         */
+        bool isLayerRendered(Layer layer) const { return (m_renderLayers & layerBit(layer)) != 0; }
+
+        /**
+         * @brief Sets how many simulation steps run per second, fixedUpdate() is called at this rate whatever the frame rate.
+         *
+         * @param ticksPerSecond The tick rate, 60 by default.
+         */
+        void setTickRate(float ticksPerSecond);
+
+        float getTickRate() const { return 1.0f / m_fixedDeltaTime; }
+
+        /**
+         * @brief Gets the length of a simulation step.
+         *
+         * @return The step length, in seconds.
+         */
+        float getFixedDeltaTime() const { return m_fixedDeltaTime; }
+
+        /**
+         * @brief Sets the most simulation steps run in one frame to catch up after a slow frame.
+         * Time beyond that is dropped, the simulation slows down instead of spiraling into longer and longer frames.
+         *
+         * @param steps The step cap, at least one.
+         */
+        void setMaxStepsPerFrame(int steps) { m_maxStepsPerFrame = std::max(steps, 1); }
+
+        int getMaxStepsPerFrame() const { return m_maxStepsPerFrame; }
+
+        /**
+         * @brief Gets how far the frame is between the last simulation step and the next one.
+         * Renderers draw interpolating transforms this far between their values before and after the last step.
+         *
+         * @return The fraction of a step, from 0 to 1.
+         */
+        float getInterpolationAlpha() const { return m_interpolationAlpha; }
+
         /**
          * @brief Loads a new scene into the engine.
          *
@@ -76,6 +217,21 @@ namespace wpwp
          */
         void addSubsystem(Subsystem &subs);
 
+        /**
+         * @brief Adds a system, run every frame after the component updates.
+         *
+         * @param system Reference to the system to add.
+         */
+        void addSystem(System &system);
+
+        /**
+         * @brief Gets the command buffer applied once per frame, after the updates.
+         * Record structural changes here while components or systems are being updated.
+         *
+         * @return Reference to the command buffer.
+         */
+        CommandBuffer &getCommandBuffer() { return m_commandBuffer; }
+
         /**
          * @brief Gets the instance of the Engine.
          *
@@ -119,6 +275,49 @@ namespace wpwp
          */
         void updateSequence();
 
+        /**
+         * @brief Runs the simulation of a frame: the fixed steps, then the updates and systems.
+         */
+        void simulate();
+
+        /**
+         * @brief Applies what the frame's simulation queued: the command buffer, the lifecycle events and the deferred signals.
+         * Only called while nothing is iterating the world.
+         */
+        void applySyncPoint();
+
+        /**
+         * @brief Hands the next frame's simulation to the simulation thread, starting it on first use.
+         */
+        void startSimulation();
+
+        /**
+         * @brief Waits for the simulation handed to the simulation thread, if any, and swaps the render lists.
+         */
+        void waitForSimulation();
+
+        /**
+         * @brief Body of the simulation thread, runs a frame every time one is handed to it.
+         */
+        void simulationLoop();
+
+        /**
+         * @brief Draws the last simulated frame's render list onto the render texture, ready for the subsystems to show.
+         */
+        void drawSnapshot();
+
+        /**
+         * @brief Runs as many simulation steps as the time accumulated since the last ones allows, up to the cap.
+         */
+        void fixedUpdateSequence();
+
+        /**
+         * @brief Calls update() or fixedUpdate() on every active component of the types that override it, one type at a time.
+         *
+         * @param fixed True for fixedUpdate().
+         */
+        void updateComponents(bool fixed);
+
         /**
          * @brief Updates all registered subsystems.
          */
@@ -144,13 +343,32 @@ namespace wpwp
         static Engine *instance; // Static pointer to the Engine instance.
         static sf::Font font;    // Static font object for rendering text.
 
-        bool m_isPaused;                             // Flag indicating whether the engine is paused.
+        bool m_isPaused = false;                     // Flag indicating whether the engine is paused.
         sf::Clock m_clock;                           // SFML clock to measure elapsed time.
         sf::Clock m_deltaClock;                      // SFML clock to measure delta time.
         sf::Text m_fpsText;                          // SFML text object for displaying FPS.
-        std::thread m_updateThread;                  // Thread for update operations.
+        std::thread m_updateThread;                  // Simulation thread of the pipelined mode, started on first use.
         std::vector<wpwp::Subsystem *> m_subsystems; // Vector of registered subsystems.
-        Scene *m_currentScene;                       // Pointer to the current scene.
+        std::vector<std::vector<bool>> m_activeRows; // Scratch buffer, per archetype, of the rows to update this frame.
+        SystemScheduler m_scheduler;                 // Runs the registered systems in parallel.
+        CommandBuffer m_commandBuffer;               // Structural changes recorded during the frame.
+        Scene *m_currentScene = nullptr;             // Pointer to the current scene.
+        LayerMask m_renderLayers = ALL_LAYERS;       // Layers renderers draw on.
+        float m_fixedDeltaTime = 1.0f / 60.0f;       // Length of a simulation step, in seconds.
+        int m_maxStepsPerFrame = 8;                  // Most simulation steps run in one frame.
+        float m_accumulator = 0.0f;                  // Frame time not simulated yet, in seconds.
+        float m_interpolationAlpha = 1.0f;           // Fraction of a step the frame is past the last step.
+
+        bool m_pipelined = false;                    // Flag indicating whether the simulation runs on m_updateThread.
+        RenderList m_renderLists[2];                 // Render list recorded by the simulation, and the one being drawn.
+        std::size_t m_recordingList = 0;             // Index of the render list the simulation records into.
+        std::mutex m_simulationMutex;                // Guards the hand-off flags.
+        std::condition_variable m_simulationSignal;  // Wakes the simulation thread, and the main thread when a frame is done.
+        bool m_simulationPending = false;            // Flag indicating whether a handed frame hasn't finished yet.
+        bool m_frameInFlight = false;                // Flag indicating whether a handed frame's render list hasn't been swapped in yet.
+        bool m_stopSimulation = false;               // Flag telling the simulation thread to exit.
+        float m_simulationTime = 0.0f;               // Length of the last simulate(), written by the thread that ran it.
+        FrameTimings m_frameTimings;                 // Timings of the last complete frame.
     };
 
 } // namespace wpwp
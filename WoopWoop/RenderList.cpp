@@ -0,0 +1,79 @@
+#include "RenderList.hpp"
+
+namespace wpwp
+{
+    void RenderList::clear()
+    {
+        m_items.clear();
+        m_views.clear();
+    }
+
+    void RenderList::setView(const sf::View &view)
+    {
+        m_items.push_back(Item{Kind::View, sf::Transform(), sf::Color(), sf::Vector2f(), m_views.size(), sf::IntRect(), nullptr});
+        m_views.push_back(view);
+    }
+
+    void RenderList::add(const sf::CircleShape &shape)
+    {
+        const float radius = shape.getRadius();
+        m_items.push_back(Item{Kind::Circle, shape.getTransform(), shape.getFillColor(), sf::Vector2f(radius, radius), shape.getPointCount(), sf::IntRect(), nullptr});
+    }
+
+    void RenderList::add(const sf::RectangleShape &shape)
+    {
+        m_items.push_back(Item{Kind::Rectangle, shape.getTransform(), shape.getFillColor(), shape.getSize(), 0, sf::IntRect(), nullptr});
+    }
+
+    void RenderList::add(const sf::Sprite &sprite, std::shared_ptr<const sf::Texture> texture)
+    {
+        if (!texture)
+        {
+            return;
+        }
+
+        m_items.push_back(Item{Kind::Sprite, sprite.getTransform(), sprite.getColor(), sf::Vector2f(), 0, sprite.getTextureRect(), std::move(texture)});
+    }
+
+    void RenderList::draw(sf::RenderTarget &target)
+    {
+        for (const Item &item : m_items)
+        {
+            // The shapes are reused at the origin, the recorded transform places them
+            sf::RenderStates states(item.transform);
+            switch (item.kind)
+            {
+            case Kind::View:
+                target.setView(m_views[item.pointCount]);
+                break;
+            case Kind::Circle:
+                // Setting the same geometry still rebuilds it, so only changes are applied
+                if (m_circle.getRadius() != item.size.x)
+                {
+                    m_circle.setRadius(item.size.x);
+                }
+                if (m_circle.getPointCount() != item.pointCount)
+                {
+                    m_circle.setPointCount(item.pointCount);
+                }
+                m_circle.setFillColor(item.color);
+                target.draw(m_circle, states);
+                break;
+            case Kind::Rectangle:
+                if (m_rectangle.getSize() != item.size)
+                {
+                    m_rectangle.setSize(item.size);
+                }
+                m_rectangle.setFillColor(item.color);
+                target.draw(m_rectangle, states);
+                break;
+            case Kind::Sprite:
+                m_sprite.setTexture(*item.texture);
+                m_sprite.setTextureRect(item.textureRect);
+                m_sprite.setColor(item.color);
+                target.draw(m_sprite, states);
+                break;
+            }
+        }
+    }
+} // namespace wpwp
@@ -0,0 +1,104 @@
+#ifndef RENDER_LIST_HPP
+#define RENDER_LIST_HPP
+
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace wpwp
+{
+    /**
+     * @brief Recorded draws of one frame, replayed later onto a render target.
+     *
+     * Each draw keeps only what it needs to be replayed (the shape's transform, fill color, size and texture),
+     * so the list stays valid after the components that recorded it change or are destroyed.
+     * Lists are cleared and refilled every frame, their storage is kept so steady frames don't allocate.
+     */
+    class RenderList
+    {
+    public:
+        /**
+         * @brief Removes every recorded draw, keeping the storage.
+         */
+        void clear();
+
+        /**
+         * @brief Records a view change, the draws after it are replayed with the view.
+         *
+         * @param view The view.
+         */
+        void setView(const sf::View &view);
+
+        /**
+         * @brief Records a circle.
+         *
+         * @param shape The circle, its outline isn't recorded.
+         */
+        void add(const sf::CircleShape &shape);
+
+        /**
+         * @brief Records a rectangle.
+         *
+         * @param shape The rectangle, its outline isn't recorded.
+         */
+        void add(const sf::RectangleShape &shape);
+
+        /**
+         * @brief Records a sprite.
+         *
+         * @param sprite The sprite.
+         * @param texture The sprite's texture, kept alive until the list is cleared.
+         */
+        void add(const sf::Sprite &sprite, std::shared_ptr<const sf::Texture> texture);
+
+        /**
+         * @brief Replays the recorded draws onto a target, in the order they were recorded.
+         *
+         * @param target The target to draw on.
+         */
+        void draw(sf::RenderTarget &target);
+
+        /**
+         * @brief Gets the amount of recorded draws.
+         *
+         * @return The recorded draw count, view changes included.
+         */
+        std::size_t size() const { return m_items.size(); }
+
+    private:
+        /**
+         * @brief What a recorded draw replays.
+         */
+        enum class Kind
+        {
+            View,
+            Circle,
+            Rectangle,
+            Sprite
+        };
+
+        /**
+         * @brief One recorded draw.
+         */
+        struct Item
+        {
+            Kind kind;                                  // What to replay.
+            sf::Transform transform;                    // Transform of the shape, origin included.
+            sf::Color color;                            // Fill color of the shape, or color of the sprite.
+            sf::Vector2f size;                          // Size of a rectangle, or radius of a circle in x.
+            std::size_t pointCount = 0;                 // Points of a circle, or index of the view for view changes.
+            sf::IntRect textureRect;                    // Part of the texture a sprite shows.
+            std::shared_ptr<const sf::Texture> texture; // Texture of a sprite.
+        };
+
+        std::vector<Item> m_items;     // Recorded draws, in order.
+        std::vector<sf::View> m_views; // Recorded views, referenced by the view changes.
+
+        sf::CircleShape m_circle;       // Reused to replay the circles.
+        sf::RectangleShape m_rectangle; // Reused to replay the rectangles.
+        sf::Sprite m_sprite;            // Reused to replay the sprites.
+    };
+} // namespace wpwp
+
+#endif // RENDER_LIST_HPP
@@ -1,5 +1,38 @@
 #include "Scene.hpp"
+#include "ECS/Entity.hpp"
 
-void wpwp::Scene::load()
+namespace wpwp
 {
-}
\ No newline at end of file
+    Scene::~Scene()
+    {
+        if (Arena::getCurrent() == m_arena.get())
+        {
+            unload();
+        }
+        Arena::dispose(std::move(m_arena));
+    }
+
+    void Scene::load()
+    {
+    }
+
+    void Scene::activate()
+    {
+        Arena::setCurrent(m_arena.get());
+    }
+
+    void Scene::unload()
+    {
+        Entity::destroyAll();
+
+        if (Arena::getCurrent() == m_arena.get())
+        {
+            Arena::setCurrent(nullptr);
+        }
+
+        if (!m_arena->release())
+        {
+            ERROR("Scene ", m_name, " unloaded with ", m_arena->getLiveCount(), " entities or components still referenced");
+        }
+    }
+}
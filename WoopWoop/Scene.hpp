@@ -1,26 +1,57 @@
 #ifndef SCENE_HPP
 #define SCENE_HPP
 
+#include <memory>
 #include <string>
+#include "Util/Arena.hpp"
 
 namespace wpwp
 {
     /**
      * @brief Base class for defining scenes in the game.
+     *
+     * Entities and components created while the scene is active are allocated from the scene's arena,
+     * unloading the scene destroys them and hands the arena's memory back at once.
      */
     struct Scene
     {
 
     public:
+        /**
+         * @brief Unloads the scene if it's still loaded and disposes of its arena.
+         */
+        virtual ~Scene();
+
         /**
          * @brief Virtual method to load the scene.
          */
         virtual void load();
 
+        /**
+         * @brief Makes new entities and components allocate from the scene's arena.
+         */
+        void activate();
+
+        /**
+         * @brief Destroys every entity, instantiated or not, and releases the scene's arena.
+         * Commands still queued in a command buffer hold entities and components too, clear the buffer first.
+         * Entities and components of the scene still referenced elsewhere keep the arena's memory,
+         * the whole arena is leaked if they are still referenced when the scene is deleted.
+         */
+        void unload();
+
         std::string getName() const { return m_name; }
 
+        /**
+         * @brief Gets the arena the scene's entities and components are allocated from.
+         *
+         * @return Reference to the arena.
+         */
+        Arena &getArena() { return *m_arena; }
+
     protected:
-        std::string m_name; // The name of the scene.
+        std::string m_name;                                         // The name of the scene.
+        std::unique_ptr<Arena> m_arena = std::make_unique<Arena>(); // Memory of the scene's entities and components.
 
         friend class SceneSerializer;
     };
@@ -1,4 +1,6 @@
 #include "SceneSerializer.hpp"
+#include <algorithm>
+#include <cstring>
 
 namespace wpwp
 {
@@ -23,71 +25,91 @@ namespace wpwp
         return out;
     }
 
-    static void serializeEntity(YAML::Emitter &out, std::shared_ptr<Entity> entity)
+    static void emitField(YAML::Emitter &out, Component &component, const FieldDescriptor &field)
     {
-        out << YAML::BeginMap;
-        out << YAML::Key << "Entity";
-        out << YAML::Value << entity->getName();
+        out << YAML::Key << field.name << YAML::Value;
+        Reflection::visit(component, field, [&](auto &value)
+                          {
+                              out << value;
+                              return false; });
+    }
 
-        for (auto c : entity->getComponents())
+    static void emitComponent(YAML::Emitter &out, Component &component, const std::vector<FieldDescriptor> &fields)
+    {
+        // Fields sharing a group are written in one map, at the position of the group's first field
+        for (std::size_t i = 0; i < fields.size(); i++)
         {
-            out << YAML::Key << c->getName();
-            out << YAML::BeginMap;
-            if (auto transform = std::dynamic_pointer_cast<Transform>(c))
+            if (!fields[i].group)
             {
-                out << YAML::Key << "Translation";
-                out << YAML::BeginMap;
-                out << YAML::Key << "Position" << YAML::Value << *transform->getPosition();
-                out << YAML::Key << "Rotation" << YAML::Value << *transform->getRotation();
-                out << YAML::Key << "Scale" << YAML::Value << *transform->getScale();
-                out << YAML::EndMap;
-
-                out << YAML::Key << "Children";
-                out << YAML::Flow << YAML::BeginSeq;
-                for (auto child : transform->getChildren())
-                {
-                    out << child->getName();
-                }
-                out << YAML::EndSeq;
+                emitField(out, component, fields[i]);
+                continue;
             }
 
-            else if (auto spriteRenderer = std::dynamic_pointer_cast<SpriteRenderer>(c))
+            bool isFirstOfGroup = std::none_of(fields.begin(), fields.begin() + i, [&](const FieldDescriptor &previous)
+                                               { return previous.group && std::strcmp(previous.group, fields[i].group) == 0; });
+            if (!isFirstOfGroup)
             {
-                out << YAML::Key << "SpritePath" << YAML::Value << spriteRenderer->getFilePath();
+                continue;
             }
 
-            else if (auto physicsBody = std::dynamic_pointer_cast<PhysicsBody2D>(c))
+            out << YAML::Key << fields[i].group;
+            out << YAML::BeginMap;
+            for (std::size_t j = i; j < fields.size(); j++)
             {
-                out << YAML::Key << "Body Type" << YAML::Value << (int)physicsBody->body->GetType();
+                if (fields[j].group && std::strcmp(fields[j].group, fields[i].group) == 0)
+                {
+                    emitField(out, component, fields[j]);
+                }
+            }
+            out << YAML::EndMap;
+        }
+    }
 
-                float density = physicsBody->body->GetFixtureList()[0].GetDensity();
-                float friction = physicsBody->body->GetFixtureList()[0].GetFriction();
-                float restitution = physicsBody->body->GetFixtureList()[0].GetRestitution();
+    static void emitEntity(YAML::Emitter &out, const Entity &entity)
+    {
+        out << YAML::BeginMap;
+        out << YAML::Key << "Entity";
+        out << YAML::Value << entity.getName();
 
-                out << YAML::Key << "Density" << YAML::Value << density;
-                out << YAML::Key << "Friction" << YAML::Value << friction;
-                out << YAML::Key << "Restitution" << YAML::Value << restitution;
-                out << YAML::Key << "Rotation Fixed" << YAML::Value << physicsBody->getRotationFixed();
-            }
+        // Tags by name, their bits depend on the order they were first used in
+        if (TagMask tags = entity.getTags())
+        {
+            out << YAML::Key << "Tags";
+            out << YAML::Value << YAML::Flow << Tags::getNames(tags);
+        }
+
+        if (Layer layer = entity.getLayer())
+        {
+            out << YAML::Key << "Layer";
+            out << YAML::Value << int(layer);
+        }
 
-            else if (auto camera = std::dynamic_pointer_cast<Camera2D>(c))
+        entity.getComponentMask().forEach([&](ComponentTypeId type)
+                                          {
+            Component *component = entity.getComponent(type);
+            const Registry::TypeMetadata *metadata = Registry::getInstance().getMetadata(type);
+
+            out << YAML::Key << (metadata ? metadata->name : component->getName());
+            out << YAML::BeginMap;
+            if (metadata)
             {
-                out << YAML::Key << "IsMain" << YAML::Value << camera->isMain;
+                emitComponent(out, *component, metadata->fields);
             }
 
-            out << YAML::EndMap; // Transform
-
-            if (auto renderer = std::dynamic_pointer_cast<Renderer>(c))
+            if (component == entity.transform)
             {
-                out << YAML::Key << "Renderer";
-                out << YAML::BeginMap;
-                out << YAML::Key << "Material";
-                out << YAML::BeginMap;
-                out << YAML::Key << "Color" << YAML::Value << renderer->material.color;
-                out << YAML::EndMap;
-                out << YAML::EndMap; // Renderer
+                out << YAML::Key << "Children";
+                out << YAML::Flow << YAML::BeginSeq;
+                for (EntityId childId : entity.transform->getChildren())
+                {
+                    if (Entity *child = Entity::get(childId))
+                    {
+                        out << child->getName();
+                    }
+                }
+                out << YAML::EndSeq;
             }
-        }
+            out << YAML::EndMap; });
 
         out << YAML::EndMap; // Entity
     }
@@ -115,11 +137,11 @@ namespace wpwp
 
         out << YAML::Key << "Entities";
         out << YAML::Value << YAML::BeginSeq;
-        for (auto entity : Entity::getAllEntities())
+        for (const auto &entity : Entity::getAllEntities())
         {
             if (entity)
             {
-                serializeEntity(out, entity);
+                emitEntity(out, *entity);
             }
         }
         out << YAML::EndSeq;
@@ -128,6 +150,13 @@ namespace wpwp
         ofs << out.c_str();
     }
 
+    YAML::Node SceneSerializer::serializeEntity(const Entity &entity)
+    {
+        YAML::Emitter out;
+        emitEntity(out, entity);
+        return YAML::Load(out.c_str());
+    }
+
     void SceneSerializer::serializeRuntime(const std::filesystem::path &filepath)
     {
     }
@@ -163,6 +192,9 @@ namespace wpwp
         auto entities = data["Entities"];
         if (entities)
         {
+            // Children can be listed before they are created, so they are linked once every entity exists
+            std::vector<std::pair<EntityId, YAML::Node>> pendingChildren;
+
             for (auto entity : entities)
             {
                 std::string name = entity["Entity"].as<std::string>();
@@ -187,118 +219,126 @@ namespace wpwp
 
                 // More detailed logging
                 LOG("Processing entity: ");
+                deserializeEntity(entity, *deserializedEntity);
 
+                if (auto transformComponent = entity["Transform"])
                 {
-                    auto transformComponent = entity["Transform"];
-                    if (transformComponent)
+                    if (auto children = transformComponent["Children"])
                     {
-                        auto transform = deserializedEntity->getComponent<Transform>();
-                        if (transform)
-                        {
-                            transform->setPosition(transformComponent["Translation"]["Position"].as<sf::Vector3f>());
-                            transform->setScale(transformComponent["Translation"]["Scale"].as<sf::Vector3f>());
-                            transform->setRotation(transformComponent["Translation"]["Rotation"].as<sf::Vector3f>());
-
-                            auto children = transformComponent["Children"];
-                            for (int i = 0; i < children.size(); i++)
-                            {
-                                transform->addChild(children[i].as<std::string>());
-                            }
-                        }
-                        else
-                        {
-                            ERROR("FAILED CONFIGURING TRANSFORM FOR: ", deserializedEntity->getName());
-                        }
-                    } // transform
+                        pendingChildren.emplace_back(deserializedEntity->getId(), children);
+                    }
                 }
+
+                LOG("Finished processing entity: ");
+            }
+
+            for (auto &[parentId, children] : pendingChildren)
+            {
+                Entity *parent = Entity::get(parentId);
+                if (!parent)
                 {
-                    if (auto spriteRendererComponent = entity["SpriteRenderer"])
-                    {
-                        auto spriteRenderer = deserializedEntity->getOrAddComponent<SpriteRenderer>().get();
-                        if (spriteRenderer)
-                        {
-                            std::string spritePath = spriteRendererComponent["SpritePath"].as<std::string>();
-                            spriteRenderer->loadSprite(spritePath);
-                        }
-                    } // Sprite renderer
-
-                    else if (auto circleRendererComponent = entity["CircleRenderer"])
-                    {
-                        auto circleRenderer = deserializedEntity->getOrAddComponent<CircleRenderer>();
-                    } // Circle renderer
+                    continue;
                 }
 
+                for (std::size_t i = 0; i < children.size(); i++)
                 {
-                    if (auto physicsBodyComponent = entity["PhysicsBody2D"])
-                    {
-                        auto physicsBody = deserializedEntity->getOrAddComponent<PhysicsBody2D>();
-                        if (physicsBody)
-                        {
-                            physicsBody->body->SetType(static_cast<b2BodyType>(physicsBodyComponent["Body Type"].as<int>()));
+                    parent->transform->addChild(children[i].as<std::string>());
+                }
+            }
+            LOG("ENDED DESERIALIZATION SUCCESSFULLY");
+            return true;
+        }
+        return false;
+    }
 
-                            physicsBody->body->GetFixtureList()[0].SetRestitution(physicsBodyComponent["Restitution"].as<float>());
-                            physicsBody->body->GetFixtureList()[0].SetDensity(physicsBodyComponent["Density"].as<float>());
-                            physicsBody->body->GetFixtureList()[0].SetFriction(physicsBodyComponent["Friction"].as<float>());
+    template <typename T>
+    static bool readField(const YAML::Node &node, T &value)
+    {
+        T read = node.as<T>();
+        if (read == value)
+        {
+            return false;
+        }
 
-                            physicsBody->setRotationFixed(physicsBodyComponent["Rotation Fixed"].as<bool>());
-                        }
-                    }
-                }
+        value = std::move(read);
+        return true;
+    }
+
+    void SceneSerializer::deserializeEntity(const YAML::Node &data, Entity &entity)
+    {
+        TagMask tags = 0;
+        if (auto tagNames = data["Tags"])
+        {
+            for (std::size_t i = 0; i < tagNames.size(); i++)
+            {
+                tags |= Tags::get(tagNames[i].as<std::string>());
+            }
+        }
+        entity.setTags(tags);
+        entity.setLayer(data["Layer"] ? static_cast<Layer>(data["Layer"].as<int>()) : 0);
 
+        for (auto it = data.begin(); it != data.end(); ++it)
+        {
+            std::string compTypeName = it->first.as<std::string>();
+            if (compTypeName == "Entity" || compTypeName == "Renderer" || compTypeName == "Tags" || compTypeName == "Layer")
+                continue;
+
+            const Registry::TypeMetadata *metadata = Registry::getInstance().getMetadata(compTypeName);
+            if (!metadata)
+            {
+                ERROR("Unknown component type: ", compTypeName);
+                continue;
+            }
+
+            Component *component = entity.getComponent(metadata->id);
+            if (!component)
+            {
+                entity.addComponent(metadata->factory());
+                component = entity.getComponent(metadata->id);
+                if (!component)
                 {
-                    if (auto cameraComponentData = entity["Camera2D"])
-                    {
-                        auto camera = deserializedEntity->getOrAddComponent<Camera2D>();
-
-                        if (camera)
-                        {
-                            if (auto isMain = cameraComponentData["IsMain"])
-                            {
-                                camera->isMain = isMain.as<bool>();
-                            }
-                        }
-                    }
+                    ERROR("FAILED ADDING ", compTypeName, " TO: ", entity.getName());
+                    continue;
                 }
+                LOG("Added ", compTypeName);
+            }
 
-                auto rendererComponent = entity["Renderer"];
-                if (rendererComponent)
+            YAML::Node componentData = it->second;
+            bool changed = false;
+            for (const FieldDescriptor &field : metadata->fields)
+            {
+                // Indexing a missing group would throw, older scenes may not have it
+                if (field.group && !componentData[field.group])
                 {
-                    auto renderer = deserializedEntity->getOrAddComponent<Renderer>();
-                    if (renderer)
-                    {
-                        renderer->material.color = rendererComponent["Material"]["Color"].as<sf::Color>();
-                    }
-                } // renderer (put after all other renderers)
+                    continue;
+                }
 
-                for (auto it = entity.begin(); it != entity.end(); ++it)
+                YAML::Node node = field.group ? componentData[field.group][field.name] : componentData[field.name];
+                if (!node)
                 {
-                    std::string compTypeName = it->first.as<std::string>();
-                    if (compTypeName == "Entity")
-                        continue;
-
-                    LOG("Added ", compTypeName);
+                    continue; // Older scenes may not have every field, the default is kept
+                }
 
-                    if (deserializedEntity->getComponent(compTypeName))
-                    {
-                        continue; // prevent the same component to be added twice if it already exists
-                    }
+                changed |= Reflection::visit(*component, field, [&](auto &value)
+                                             { return readField(node, value); });
+            }
 
-                    else
-                    {
-                        auto comp = Registry::getInstance().createInstance(compTypeName);
-                        if (comp)
-                        {
-                            deserializedEntity->addComponent(std::move(comp));
-                        }
-                    }
-                }
+            if (changed)
+            {
+                component->markChanged();
+            }
+        }
 
-                LOG("Finished processing entity: ");
+        // Scenes saved before the renderers were reflected keep the color in a separate entry
+        auto rendererComponent = data["Renderer"];
+        if (rendererComponent)
+        {
+            auto renderer = entity.getComponent<Renderer>();
+            if (renderer)
+            {
+                renderer->material.color = rendererComponent["Material"]["Color"].as<sf::Color>();
             }
-            LOG("ENDED DESERIALIZATION SUCCESSFULLY");
-            return true;
         }
-        return false;
     }
 
     bool SceneSerializer::deserializeRuntime(const std::filesystem::path &filepath)
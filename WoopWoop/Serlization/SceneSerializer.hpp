@@ -46,8 +46,27 @@ namespace wpwp
 
         bool deserializeRuntime(const std::filesystem::path &filepath);
 
-    private:
-        std::filesystem::path generatePath(const std::filesystem::path &filepath);
+        /**
+         * @brief Serializes a single entity and its components.
+         * @param entity The entity to serialize.
+         * @return The YAML node of the entity, in the same format as the entries of a scene file.
+         */
+        static YAML::Node serializeEntity(const Entity &entity);
+
+        /**
+         * @brief Applies the components of a serialized entity to an entity, adding the ones it's missing.
+         * Children aren't linked, they may not exist yet.
+         * @param data The YAML node of the entity.
+         * @param entity The entity to apply the components to.
+         */
+        static void deserializeEntity(const YAML::Node &data, Entity &entity);
+
+        /**
+         * @brief Gets the path of a scene file from its name.
+         * @param filepath The name of the scene.
+         * @return The path of the scene file.
+         */
+        static std::filesystem::path generatePath(const std::filesystem::path &filepath);
 
     private:
         const Scene &m_scene; // Reference to the Scene object.
@@ -2,11 +2,20 @@
 #include "Util/Util.hpp"
 #include "ECS/Entity.hpp"
 #include "ECS/Components/Transform.hpp"
+#include "ECS/Components/Box2D/PhysicsBody2D.hpp"
 #include "ImGuiSub.hpp"
+#include <algorithm>
+#include <cmath>
 
 namespace wpwp
 {
     std::shared_ptr<b2World> Box2DIntegration::m_world;
+    std::array<LayerMask, MAX_LAYERS> Box2DIntegration::s_collisionMasks = []
+    {
+        std::array<LayerMask, MAX_LAYERS> masks;
+        masks.fill(ALL_LAYERS);
+        return masks;
+    }();
 
     void Box2DIntegration::init()
     {
@@ -47,9 +56,45 @@ namespace wpwp
         }
     }
 
-    void Box2DIntegration::update()
+    void Box2DIntegration::setLayersCollide(Layer a, Layer b, bool collide)
+    {
+        if (a >= MAX_LAYERS || b >= MAX_LAYERS)
+        {
+            ERROR("Layer out of range, there are ", MAX_LAYERS, " layers");
+            return;
+        }
+
+        // Box2D needs both sides to agree, so the matrix is kept symmetric
+        if (collide)
+        {
+            s_collisionMasks[a] |= layerBit(b);
+            s_collisionMasks[b] |= layerBit(a);
+        }
+        else
+        {
+            s_collisionMasks[a] &= static_cast<LayerMask>(~layerBit(b));
+            s_collisionMasks[b] &= static_cast<LayerMask>(~layerBit(a));
+        }
+    }
+
+    void Box2DIntegration::fixedUpdate(float deltaTime)
     {
-        if (!Engine::getInstance()->m_isPaused)
-            m_world->Step(1.0f / 900.0f, 6, 2);
+        // Split so no step of the world is longer than MAX_SUBSTEP
+        const int substeps = std::max(1, static_cast<int>(std::ceil(deltaTime / MAX_SUBSTEP)));
+        const float substep = deltaTime / substeps;
+        for (int i = 0; i < substeps; i++)
+        {
+            m_world->Step(substep, 6, 2);
+        }
+
+        // Synced here rather than in the components' fixedUpdate(), which runs before the step and would leave transforms a step behind
+        for (b2Body *body = m_world->GetBodyList(); body; body = body->GetNext())
+        {
+            auto *physicsBody = reinterpret_cast<PhysicsBody2D *>(body->GetUserData().pointer);
+            if (physicsBody && body->IsEnabled())
+            {
+                physicsBody->onWorldStepped();
+            }
+        }
     }
 }
\ No newline at end of file
@@ -2,8 +2,10 @@
 #define BOX2D_INTEGRATION_HPP
 
 #include <Util/Subsystem.hpp>
+#include <array>
 #include <memory>
 #include "box2d/box2d.h"
+#include "ECS/Tags.hpp"
 
 namespace wpwp
 {
@@ -11,12 +13,39 @@ namespace wpwp
     {
     public:
         void init() override;
-        void update() override;
+
+        /**
+         * @brief Steps the world, then writes every enabled body back to its entity's transform.
+         *
+         * @param deltaTime The length of a step, in seconds.
+         */
+        void fixedUpdate(float deltaTime) override;
 
         static b2World *getWorld() { return m_world.get(); }
 
+        static constexpr float MAX_SUBSTEP = 1.0f / 900.0f; // Longest time the world is stepped by at once, the scene is in pixels so motion per step stays small.
+
+        /**
+         * @brief Sets whether bodies on two layers collide, every layer collides with every layer by default.
+         * Bodies pick the change up on their next update.
+         *
+         * @param a The first layer.
+         * @param b The second layer.
+         * @param collide True if they collide.
+         */
+        static void setLayersCollide(Layer a, Layer b, bool collide);
+
+        /**
+         * @brief Gets the layers bodies on a layer collide with.
+         *
+         * @param layer The layer.
+         * @return The colliding layers, used as the fixtures' mask bits.
+         */
+        static LayerMask getCollisionMask(Layer layer) { return s_collisionMasks[layer]; }
+
     private:
         static std::shared_ptr<b2World> m_world;
+        static std::array<LayerMask, MAX_LAYERS> s_collisionMasks; // Colliding layers of each layer.
     };
 };
 #endif
\ No newline at end of file
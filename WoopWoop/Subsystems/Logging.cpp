@@ -4,6 +4,7 @@
 
 std::vector<wpwp::Log> wpwp::Logging::s_logs{};
 std::map<wpwp::Log, int> wpwp::Logging::s_logMapCount{};
+std::mutex wpwp::Logging::s_mutex;
 
 void wpwp::Logging::init()
 {
@@ -51,6 +52,7 @@ void wpwp::Logging::renderLogs()
 
 void wpwp::Logging::clear()
 {
+    std::lock_guard<std::mutex> lock(s_mutex);
     s_logMapCount.clear();
     s_logs.clear();
 }
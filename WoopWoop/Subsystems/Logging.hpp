@@ -12,6 +12,7 @@
 #include <chrono>
 #include <ctime>
 #include <fstream>
+#include <mutex>
 #include "ECS/Component.hpp"
 
 // Macros for logging messages with file and line information
@@ -107,6 +108,9 @@ namespace wpwp
             prefix += std::to_string(line);
 
             std::string message = os.str();
+
+            // The simulation thread logs alongside the main one in pipelined mode
+            std::lock_guard<std::mutex> lock(s_mutex);
 #ifdef DEBUG
             std::cout << prefix << " " << message << std::endl;
 #endif
@@ -156,6 +160,7 @@ namespace wpwp
     private:
         static std::vector<Log> s_logs;          // Vector storing all log entries.
         static std::map<Log, int> s_logMapCount; // Map storing log entries and their counts.
+        static std::mutex s_mutex;               // Guards the logs and the log file.
         friend Editor::Editor;                   // Allows Editor class to access private members.
     };
 
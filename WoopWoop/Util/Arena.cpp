@@ -0,0 +1,134 @@
+#include "Arena.hpp"
+#include "Subsystems/Logging.hpp"
+
+namespace wpwp
+{
+    std::atomic<Arena *> Arena::s_current = nullptr;
+    std::atomic<std::size_t> Arena::s_poolCount = 0;
+
+    Arena::Arena(std::size_t initialBlockSize)
+        : m_buffer(std::make_unique<std::pmr::monotonic_buffer_resource>(initialBlockSize))
+    {
+    }
+
+    Arena::~Arena()
+    {
+        if (getCurrent() == this)
+        {
+            setCurrent(nullptr);
+        }
+
+        if (m_liveCount != 0)
+        {
+            ERROR("Arena destroyed with ", m_liveCount.load(), " live allocations, they now free into a destroyed arena");
+        }
+    }
+
+    void Arena::dispose(std::unique_ptr<Arena> arena)
+    {
+        if (!arena)
+        {
+            return;
+        }
+
+        if (getCurrent() == arena.get())
+        {
+            setCurrent(nullptr);
+        }
+
+        if (arena->getLiveCount() != 0)
+        {
+            // The blocks, the pools and the live count are all still used by the surviving allocations
+            ERROR("Arena disposed with ", arena->getLiveCount(), " live allocations, leaking it and its ", arena->getAllocatedBytes(), " bytes");
+            arena.release();
+        }
+    }
+
+    bool Arena::release()
+    {
+        if (m_liveCount != 0)
+        {
+            return false;
+        }
+
+        // Before taking the lock, a pool holds its own lock while it takes the arena's for a slab
+        for (auto &pool : m_pools)
+        {
+            if (SlabPool *slabPool = pool.load(std::memory_order_acquire))
+            {
+                slabPool->reset();
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_liveCount != 0)
+        {
+            return false;
+        }
+
+        m_buffer->release();
+        m_allocatedBytes = 0;
+        return true;
+    }
+
+    std::pmr::memory_resource &Arena::getPool(std::size_t index)
+    {
+        if (index >= MAX_POOLS)
+        {
+            return *this;
+        }
+
+        if (SlabPool *pool = m_pools[index].load(std::memory_order_acquire))
+        {
+            return *pool;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        SlabPool *pool = m_pools[index].load(std::memory_order_relaxed);
+        if (!pool)
+        {
+            pool = m_ownedPools.emplace_back(std::make_unique<SlabPool>(*this)).get();
+            m_pools[index].store(pool, std::memory_order_release);
+        }
+
+        return *pool;
+    }
+
+    Arena *Arena::getCurrent()
+    {
+        if (Arena *arena = s_current.load(std::memory_order_acquire))
+        {
+            return arena;
+        }
+
+        // Never destroyed, entities in statics may still be freed into it after main returns
+        static Arena *processArena = new Arena();
+        return processArena;
+    }
+
+    void Arena::setCurrent(Arena *arena)
+    {
+        s_current.store(arena, std::memory_order_release);
+    }
+
+    void *Arena::do_allocate(std::size_t bytes, std::size_t alignment)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        void *pointer = m_buffer->allocate(bytes, alignment);
+        m_allocatedBytes += bytes;
+        m_liveCount.fetch_add(1, std::memory_order_relaxed);
+        return pointer;
+    }
+
+    void *Arena::allocateSlab(std::size_t bytes, std::size_t alignment)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_allocatedBytes += bytes;
+        return m_buffer->allocate(bytes, alignment);
+    }
+
+    void Arena::do_deallocate(void *, std::size_t, std::size_t)
+    {
+        m_liveCount.fetch_sub(1, std::memory_order_relaxed);
+    }
+} // namespace wpwp
@@ -0,0 +1,145 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+#include "SlabPool.hpp"
+
+namespace wpwp
+{
+    /**
+     * @brief Monotonic memory resource whose memory is handed back all at once, safe to allocate from several threads.
+     *
+     * Allocations are carved out of a few large blocks, deallocating only counts the allocation as freed.
+     * The blocks go back to the heap in one go with release(), which refuses to while anything allocated from the arena is alive.
+     * Objects created with makeShared() come from a slab pool per type, so destroyed ones leave blocks the next ones of the same type reuse.
+     */
+    class Arena : public std::pmr::memory_resource
+    {
+    public:
+        /**
+         * @brief Creates an empty arena, no memory is taken until the first allocation.
+         *
+         * @param initialBlockSize Size of the first block, the following ones grow geometrically.
+         */
+        explicit Arena(std::size_t initialBlockSize = 64 * 1024);
+
+        /**
+         * @brief Releases the blocks and the pools.
+         * Allocations still alive would free into a destroyed arena, an arena that may still be referenced goes through dispose() instead.
+         */
+        ~Arena() override;
+
+        Arena(const Arena &) = delete;
+        Arena &operator=(const Arena &) = delete;
+
+        /**
+         * @brief Gives every block back to the heap, in time proportional to the block count.
+         *
+         * @return False if allocations are still alive, the blocks are kept then.
+         */
+        bool release();
+
+        /**
+         * @brief Destroys an arena, or leaks it whole if allocations are still alive.
+         * Shared pointers made by makeShared() keep an allocator pointing at the arena's pools, so the arena must outlive every one of them.
+         *
+         * @param arena The arena to destroy.
+         */
+        static void dispose(std::unique_ptr<Arena> arena);
+
+        /**
+         * @brief Gets the amount of allocations not freed yet.
+         *
+         * @return The live allocation count.
+         */
+        std::size_t getLiveCount() const { return m_liveCount.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Gets the amount of bytes handed out since the last release.
+         *
+         * @return The allocated byte count, freed allocations included.
+         */
+        std::size_t getAllocatedBytes() const { return m_allocatedBytes; }
+
+        /**
+         * @brief Gets the slab pool of a type, creating it on first use.
+         *
+         * @param index The pool index of the type, from poolIndex().
+         * @return The pool, or the arena itself if there are more types than MAX_POOLS.
+         */
+        std::pmr::memory_resource &getPool(std::size_t index);
+
+        /**
+         * @brief Gets the arena entities and components are currently allocated from.
+         *
+         * @return The current arena, a process wide one unless a scene set one.
+         */
+        static Arena *getCurrent();
+
+        /**
+         * @brief Sets the arena entities and components are allocated from.
+         *
+         * @param arena The arena, nullptr for the process wide one.
+         */
+        static void setCurrent(Arena *arena);
+
+        /**
+         * @brief Creates an object and its control block in a single block of the type's slab pool in the current arena.
+         *
+         * @tparam T The type of the object.
+         * @param args The arguments of T's constructor.
+         * @return A shared pointer to the object.
+         */
+        template <typename T, typename... Args>
+        static std::shared_ptr<T> makeShared(Args &&...args)
+        {
+            std::pmr::memory_resource &pool = getCurrent()->getPool(poolIndex<T>());
+            return std::allocate_shared<T>(std::pmr::polymorphic_allocator<T>(&pool), std::forward<Args>(args)...);
+        }
+
+        /**
+         * @brief Gets the index of a type's slab pool, the same in every arena.
+         *
+         * @tparam T The type.
+         * @return The pool index, assigned on first use.
+         */
+        template <typename T>
+        static std::size_t poolIndex()
+        {
+            static const std::size_t index = s_poolCount.fetch_add(1, std::memory_order_relaxed);
+            return index;
+        }
+
+        static constexpr std::size_t MAX_POOLS = 512; // Most types with a slab pool, the others allocate from the arena directly.
+
+    private:
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void *pointer, std::size_t bytes, std::size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+        /**
+         * @brief Takes memory for a slab, not counted as a live allocation since the pool counts its blocks.
+         */
+        void *allocateSlab(std::size_t bytes, std::size_t alignment);
+
+        friend class SlabPool;
+
+    private:
+        std::mutex m_mutex;                                            // Guards the buffer and the pool list, components may be created from worker threads.
+        std::unique_ptr<std::pmr::monotonic_buffer_resource> m_buffer; // Hands out the memory, owns the blocks.
+        std::atomic<std::size_t> m_liveCount = 0;                      // Allocations and pool blocks not freed yet.
+        std::size_t m_allocatedBytes = 0;                              // Bytes handed out since the last release.
+        std::array<std::atomic<SlabPool *>, MAX_POOLS> m_pools{};      // Slab pool of each type, by pool index, read without the lock.
+        std::vector<std::unique_ptr<SlabPool>> m_ownedPools;           // Owns the created pools.
+
+        static std::atomic<Arena *> s_current;       // Arena entities and components are allocated from, nullptr for the process wide one.
+        static std::atomic<std::size_t> s_poolCount; // Pool indices handed out so far.
+    };
+} // namespace wpwp
+
+#endif // ARENA_HPP
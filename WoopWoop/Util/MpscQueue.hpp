@@ -0,0 +1,174 @@
+#ifndef MPSC_QUEUE_HPP
+#define MPSC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace wpwp
+{
+    /**
+     * @brief Bounded lock-free queue any amount of threads can push to and a single thread pops from.
+     *
+     * A ring of cells each carrying a sequence number: a producer claims a cell by advancing the shared push position
+     * with a compare and swap, writes the value and publishes it through the cell's sequence, the consumer reads it back the same way.
+     * Nothing allocates after construction, a push on a full queue fails instead of waiting.
+     *
+     * @tparam T The type of the values, must be move constructible.
+     */
+    template <typename T>
+    class MpscQueue
+    {
+    public:
+        /**
+         * @brief Creates an empty queue.
+         *
+         * @param capacity Most values the queue holds at once, rounded up to a power of two.
+         */
+        explicit MpscQueue(std::size_t capacity)
+        {
+            std::size_t size = 2;
+            while (size < capacity)
+            {
+                size *= 2;
+            }
+
+            m_mask = size - 1;
+            m_cells = std::make_unique<Cell[]>(size);
+            for (std::size_t i = 0; i < size; i++)
+            {
+                m_cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * @brief Destroys the values still queued, no producer may push anymore.
+         */
+        ~MpscQueue()
+        {
+            for (;;)
+            {
+                Cell &cell = m_cells[m_popPosition & m_mask];
+                if (cell.sequence.load(std::memory_order_acquire) != m_popPosition + 1)
+                {
+                    break;
+                }
+                std::launder(reinterpret_cast<T *>(cell.storage))->~T();
+                m_popPosition++;
+            }
+        }
+
+        MpscQueue(const MpscQueue &) = delete;
+        MpscQueue &operator=(const MpscQueue &) = delete;
+
+        /**
+         * @brief Queues a value, safe from any thread.
+         *
+         * @param value The value to queue.
+         * @return False if the queue is full, the value isn't moved from then.
+         */
+        template <typename U>
+        bool tryPush(U &&value)
+        {
+            std::size_t position = m_pushPosition.load(std::memory_order_relaxed);
+            Cell *cell;
+            for (;;)
+            {
+                cell = &m_cells[position & m_mask];
+                const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                const std::intptr_t difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+
+                if (difference == 0)
+                {
+                    // The cell is free for this lap, claim it
+                    if (m_pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (difference < 0)
+                {
+                    // The consumer hasn't emptied the cell since the previous lap
+                    return false;
+                }
+                else
+                {
+                    // Another producer claimed the cell first
+                    position = m_pushPosition.load(std::memory_order_relaxed);
+                }
+            }
+
+            new (cell->storage) T(std::forward<U>(value));
+            cell->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Takes the oldest value out of the queue, only from the consumer thread.
+         *
+         * @param value Receives the value.
+         * @return False if the queue is empty, or the next value is claimed but not written yet.
+         */
+        bool tryPop(T &value)
+        {
+            return tryPopWith([&value](T &&stored)
+                              { value = std::move(stored); });
+        }
+
+        /**
+         * @brief Hands the oldest value to a function while it's still in its cell, only from the consumer thread.
+         * Nothing is constructed on the consumer's side, so T needs neither a default constructor nor move assignment.
+         *
+         * @param consume Called with the value as an rvalue, it may move from it. The cell is freed once it returns.
+         * @return False if the queue is empty, or the next value is claimed but not written yet.
+         */
+        template <typename F>
+        bool tryPopWith(F &&consume)
+        {
+            Cell &cell = m_cells[m_popPosition & m_mask];
+            if (cell.sequence.load(std::memory_order_acquire) != m_popPosition + 1)
+            {
+                return false;
+            }
+
+            T *stored = std::launder(reinterpret_cast<T *>(cell.storage));
+            consume(std::move(*stored));
+            stored->~T();
+
+            // Frees the cell for the producers of the next lap
+            cell.sequence.store(m_popPosition + m_mask + 1, std::memory_order_release);
+            m_popPosition++;
+            return true;
+        }
+
+        /**
+         * @brief Gets the most values the queue holds at once.
+         *
+         * @return The capacity.
+         */
+        std::size_t getCapacity() const { return m_mask + 1; }
+
+    private:
+        /**
+         * @brief One value of the ring and the sequence telling whose turn it is.
+         * Equal to its position when free for a producer, to position + 1 once written.
+         */
+        struct Cell
+        {
+            std::atomic<std::size_t> sequence;       // Turn of the cell.
+            alignas(T) std::byte storage[sizeof(T)]; // The value, constructed while the cell is written.
+        };
+
+        static constexpr std::size_t CACHE_LINE = 64;
+
+        std::unique_ptr<Cell[]> m_cells;                                 // The ring.
+        std::size_t m_mask = 0;                                          // Capacity minus one.
+        alignas(CACHE_LINE) std::atomic<std::size_t> m_pushPosition = 0; // Next position to claim, shared by the producers.
+        alignas(CACHE_LINE) std::size_t m_popPosition = 0;               // Next position to read, only touched by the consumer.
+    };
+} // namespace wpwp
+
+#endif // MPSC_QUEUE_HPP
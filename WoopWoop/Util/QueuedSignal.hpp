@@ -0,0 +1,125 @@
+#ifndef QUEUED_SIGNAL_HPP
+#define QUEUED_SIGNAL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "MpscQueue.hpp"
+#include "Signal.hpp"
+
+namespace wpwp
+{
+    /**
+     * @brief Signal that can be invoked from any thread, its functions run later on the thread draining it.
+     *
+     * Posting copies the arguments into a bounded lock-free queue, drain() calls the functions with each posted set of arguments in order.
+     * Binding and draining are for a single thread, usually the main one, where drainOn() ties the draining to a frame phase
+     * such as Engine::onStartOfFrame.
+     *
+     * @tparam R The types of arguments for the signal, stored decayed until drained.
+     */
+    template <typename... R>
+    class QueuedSignal
+    {
+    public:
+        static constexpr std::size_t DEFAULT_CAPACITY = 1024; // Posts held at once by default.
+
+        /**
+         * @brief Creates a signal with an empty queue.
+         *
+         * @param capacity Most posts held at once before posting fails, rounded up to a power of two.
+         */
+        explicit QueuedSignal(std::size_t capacity = DEFAULT_CAPACITY) : m_queue(capacity) {}
+
+        QueuedSignal(const QueuedSignal &) = delete;
+        QueuedSignal &operator=(const QueuedSignal &) = delete;
+
+        /**
+         * @brief Queues an invocation, safe from any thread and never blocks.
+         *
+         * @param args The arguments the functions are called with when drained.
+         * @return False if the queue is full, the invocation is dropped and counted then.
+         */
+        bool post(R... args)
+        {
+            if (m_queue.tryPush(Arguments(std::move(args)...)))
+            {
+                return true;
+            }
+
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        /**
+         * @brief Calls the functions once per queued invocation, oldest first. Only from the draining thread.
+         * Invocations posted while draining are left for the next drain once the queue's capacity is reached, so it always ends.
+         *
+         * @return The amount of invocations delivered.
+         */
+        std::size_t drain()
+        {
+            // Called on the arguments in their cell, so they don't need to be default constructible
+            auto deliver = [this](Arguments &&args)
+            {
+                std::apply([this](auto &...values)
+                           { m_signal.invoke(values...); }, args);
+            };
+
+            std::size_t delivered = 0;
+            while (delivered < m_queue.getCapacity() && m_queue.tryPopWith(deliver))
+            {
+                delivered++;
+            }
+            return delivered;
+        }
+
+        /**
+         * @brief Drains the queue every time a phase signal is invoked.
+         *
+         * @param phase The signal marking the phase, for example Engine::onEndOfFrame.
+         * @return The handle keeping the drain bound, this signal must outlive it.
+         */
+        [[nodiscard]] ScopedConnection drainOn(Signal<> &phase)
+        {
+            return phase.connect([this]()
+                                 { drain(); });
+        }
+
+        /**
+         * @brief Binds a function called by drain(), only from the draining thread.
+         *
+         * @param f The function to bind.
+         * @return A handle to unbind the function with.
+         */
+        template <typename F>
+        Connection bind(F &&f) { return m_signal.bind(std::forward<F>(f)); }
+
+        /**
+         * @brief Binds a function for as long as the returned handle lives, only from the draining thread.
+         *
+         * @param f The function to bind.
+         * @return The handle, unbinding the function when destroyed.
+         */
+        template <typename F>
+        [[nodiscard]] ScopedConnection connect(F &&f) { return m_signal.connect(std::forward<F>(f)); }
+
+        /**
+         * @brief Gets the amount of posts dropped because the queue was full.
+         *
+         * @return The dropped post count.
+         */
+        std::size_t getDroppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    private:
+        using Arguments = std::tuple<std::decay_t<R>...>;
+
+        MpscQueue<Arguments> m_queue;           // Posted invocations waiting for the drain.
+        Signal<R...> m_signal;                  // Functions called by the drain.
+        std::atomic<std::size_t> m_dropped = 0; // Posts dropped because the queue was full.
+    };
+} // namespace wpwp
+
+#endif // QUEUED_SIGNAL_HPP
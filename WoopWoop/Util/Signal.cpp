@@ -0,0 +1,42 @@
+#include "Signal.hpp"
+
+namespace wpwp
+{
+    std::mutex DeferredSignals::s_mutex;
+    std::vector<std::weak_ptr<SlotTableBase>> DeferredSignals::s_pending;
+    std::vector<std::weak_ptr<SlotTableBase>> DeferredSignals::s_flushing;
+
+    void DeferredSignals::enqueue(std::weak_ptr<SlotTableBase> table)
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        s_pending.push_back(std::move(table));
+    }
+
+    void DeferredSignals::flush()
+    {
+        {
+            std::lock_guard<std::mutex> lock(s_mutex);
+            if (s_pending.empty())
+            {
+                return;
+            }
+            std::swap(s_pending, s_flushing);
+        }
+
+        // Signals destroyed since they were invoked are skipped, the lock keeps the others alive while their functions run
+        for (const auto &pending : s_flushing)
+        {
+            if (auto table = pending.lock())
+            {
+                table->dispatchDeferred();
+            }
+        }
+        s_flushing.clear();
+    }
+
+    std::size_t DeferredSignals::getPendingCount()
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        return s_pending.size();
+    }
+} // namespace wpwp
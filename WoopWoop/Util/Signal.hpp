@@ -1,58 +1,325 @@
 #ifndef SIGNAL_HPP
 #define SIGNAL_HPP
 
-#include <functional>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
-#include <algorithm>
 
 namespace wpwp
 {
+    /**
+     * @brief Type erased part of a signal's slot table, what a connection needs to disconnect.
+     */
+    class SlotTableBase : public std::enable_shared_from_this<SlotTableBase>
+    {
+    public:
+        virtual ~SlotTableBase() = default;
+
+        virtual void disconnect(std::uint32_t index, std::uint32_t generation) = 0;
+        virtual bool isConnected(std::uint32_t index, std::uint32_t generation) const = 0;
+
+        /**
+         * @brief Calls the functions with the arguments of the last deferred invocation.
+         */
+        virtual void dispatchDeferred() = 0;
+    };
+
+    /**
+     * @brief Queue of the deferred signals invoked since the last flush.
+     */
+    class DeferredSignals
+    {
+    public:
+        /**
+         * @brief Calls the functions of every deferred signal invoked since the last flush, once per signal.
+         * Signals invoked by those functions are delivered by the next flush. Called by the engine once per frame.
+         */
+        static void flush();
+
+        /**
+         * @brief Gets the amount of signals waiting for the next flush.
+         *
+         * @return The pending signal count.
+         */
+        static std::size_t getPendingCount();
+
+    private:
+        static void enqueue(std::weak_ptr<SlotTableBase> table);
+
+        static std::mutex s_mutex;                                   // Guards the queue, transforms may be changed from worker threads.
+        static std::vector<std::weak_ptr<SlotTableBase>> s_pending;  // Signals invoked since the last flush.
+        static std::vector<std::weak_ptr<SlotTableBase>> s_flushing; // Signals being delivered, swapped with s_pending to keep both buffers.
+
+        template <typename... R>
+        friend struct Signal;
+    };
+
+    /**
+     * @brief Handle to a function bound to a signal, disconnecting it doesn't search the signal.
+     * Copyable and non-owning, the function stays bound when the handle goes away, see ScopedConnection for that.
+     * Outliving the signal is safe, the handle then reports being disconnected.
+     */
+    class Connection
+    {
+    public:
+        Connection() = default;
+
+        /**
+         * @brief Unbinds the function in constant time, does nothing if it was already unbound.
+         * Safe from inside the signal's own invocation, the function isn't called again after this.
+         */
+        void disconnect()
+        {
+            if (auto table = m_table.lock())
+            {
+                table->disconnect(m_index, m_generation);
+            }
+            m_table.reset();
+        }
+
+        /**
+         * @brief Checks if the function is still bound.
+         *
+         * @return True if the signal is alive and the function wasn't unbound.
+         */
+        bool isConnected() const
+        {
+            auto table = m_table.lock();
+            return table && table->isConnected(m_index, m_generation);
+        }
+
+    private:
+        Connection(std::weak_ptr<SlotTableBase> table, std::uint32_t index, std::uint32_t generation)
+            : m_table(std::move(table)), m_index(index), m_generation(generation) {}
+
+        std::weak_ptr<SlotTableBase> m_table; // Slots of the signal.
+        std::uint32_t m_index = 0;            // Slot of the function.
+        std::uint32_t m_generation = 0;       // Generation of the slot when the function was bound.
+
+        template <typename... R>
+        friend struct Signal;
+    };
+
+    /**
+     * @brief Connection that disconnects when it goes out of scope, for listeners that don't live as long as the signal.
+     */
+    class ScopedConnection
+    {
+    public:
+        ScopedConnection() = default;
+        ScopedConnection(Connection connection) : m_connection(std::move(connection)) {}
+        ~ScopedConnection() { m_connection.disconnect(); }
+
+        ScopedConnection(ScopedConnection &&other) noexcept : m_connection(std::exchange(other.m_connection, Connection())) {}
+        ScopedConnection &operator=(ScopedConnection &&other) noexcept
+        {
+            if (this != &other)
+            {
+                m_connection.disconnect();
+                m_connection = std::exchange(other.m_connection, Connection());
+            }
+            return *this;
+        }
+
+        ScopedConnection(const ScopedConnection &) = delete;
+        ScopedConnection &operator=(const ScopedConnection &) = delete;
+
+        void disconnect() { m_connection.disconnect(); }
+        bool isConnected() const { return m_connection.isConnected(); }
+
+        /**
+         * @brief Gives up ownership, the function stays bound.
+         *
+         * @return The plain connection.
+         */
+        Connection release() { return std::exchange(m_connection, Connection()); }
+
+    private:
+        Connection m_connection; // The owned connection.
+    };
+
     /**
      * @brief A signal class for handling function callbacks with a variable number of arguments.
      *
+     * Bound functions are stored inline in fixed slots when they fit (captures up to INLINE_SIZE bytes), so binding a typical
+     * lambda and invoking the signal never allocate per call. Slots never move, so functions can bind, unbind,
+     * and invoke the signal again from inside an invocation; functions bound during an invocation are first called by the next one.
+     *
+     * A deferred signal doesn't call its functions when invoked, it waits for DeferredSignals::flush() and then calls each
+     * function once with the arguments of the last invocation, however many times it was invoked in between.
+     * Deferred invocations may come from several threads at once, binding, unbinding and immediate invocations stay on one thread.
+     *
      * @tparam R The types of arguments for the signal.
      */
     template <typename... R>
     struct Signal
     {
     public:
+        static constexpr std::size_t INLINE_SIZE = 4 * sizeof(void *); // Largest function stored without a heap allocation.
+
+        Signal() = default;
+
+        /**
+         * @brief Creates a signal with copies of another signal's bound functions.
+         */
+        Signal(const Signal &other)
+        {
+            combine(*this, other);
+            m_deferred = other.m_deferred;
+        }
+
+        Signal &operator=(const Signal &other)
+        {
+            if (this != &other)
+            {
+                releaseTable();
+                combine(*this, other);
+                m_deferred = other.m_deferred;
+            }
+            return *this;
+        }
+
+        Signal(Signal &&) noexcept = default;
+
+        Signal &operator=(Signal &&other) noexcept
+        {
+            if (this != &other)
+            {
+                releaseTable();
+                m_table = std::move(other.m_table);
+                m_deferred = other.m_deferred;
+            }
+            return *this;
+        }
+
+        ~Signal() { releaseTable(); }
+
+        /**
+         * @brief Creates a signal whose invocations are delivered by DeferredSignals::flush().
+         *
+         * @return The deferred signal.
+         */
+        static Signal deferred()
+        {
+            Signal signal;
+            signal.setDeferred(true);
+            return signal;
+        }
+
+        /**
+         * @brief Sets whether invocations are delivered right away or by the next DeferredSignals::flush().
+         * An invocation already waiting for the flush is still delivered by it.
+         *
+         * @param deferred True to defer the invocations.
+         */
+        void setDeferred(bool deferred) { m_deferred = deferred; }
+
+        bool isDeferred() const { return m_deferred; }
+
         /**
          * @brief Invokes all connected functions with the provided arguments.
+         * A deferred signal only keeps the arguments, the functions are called by the next flush.
          *
-         * @param args The arguments to pass to the connected functions.
+         * @param args The arguments to pass to the connected functions, every function gets the same ones.
          */
         void invoke(R... args)
         {
-            for (auto &f : m_functions)
+            // Not copied, releaseTable() keeps the table alive if a function destroys or reassigns the signal
+            SlotTable *table = m_table.get();
+            if (!table)
             {
-                f(std::forward<R>(args)...);
+                return;
             }
+
+            if (m_deferred)
+            {
+                table->defer(args...);
+                return;
+            }
+
+            table->dispatch(args...);
         }
 
         /**
          * @brief Binds a function to the signal.
          *
+         * @param f The function to bind, any copyable callable taking the signal's arguments.
+         * @return A handle to unbind the function with.
+         */
+        template <typename F>
+            requires std::is_invocable_v<std::decay_t<F> &, R &...>
+        Connection bind(F &&f)
+        {
+            if (!m_table)
+            {
+                m_table = std::make_shared<SlotTable>();
+            }
+
+            std::uint32_t index = m_table->acquire();
+            Slot &slot = m_table->slots[index];
+            slot.ops = &opsFor<std::decay_t<F>>;
+            construct<std::decay_t<F>>(slot.storage, std::forward<F>(f));
+            slot.connected = true;
+            m_table->connectedCount.fetch_add(1, std::memory_order_relaxed);
+            return Connection(m_table, index, slot.generation);
+        }
+
+        /**
+         * @brief Binds a function for as long as the returned handle lives.
+         *
          * @param f The function to bind.
+         * @return The handle, unbinding the function when destroyed.
          */
-        void bind(std::function<void(R...)> &&f)
+        template <typename F>
+            requires std::is_invocable_v<std::decay_t<F> &, R &...>
+        [[nodiscard]] ScopedConnection connect(F &&f)
         {
-            m_functions.emplace_back(std::forward<std::function<void(R...)>>(f));
+            return ScopedConnection(bind(std::forward<F>(f)));
         }
 
         /**
          * @brief Unbinds a function from the signal.
          *
-         * @param f The function to unbind.
+         * @param connection The handle returned when the function was bound.
          */
-        void unbind(std::function<void(R...)> &&f)
+        void unbind(Connection connection)
         {
-            auto it = std::remove_if(m_functions.begin(), m_functions.end(),
-                                     [&](const std::function<void(R...)> &func)
-                                     {
-                                         return f.target_type() == func.target_type() && *f.template target<void(R...)>() == *func.template target<void(R...)>();
-                                     });
+            connection.disconnect();
+        }
+
+        /**
+         * @brief Unbinds every function.
+         */
+        void clear()
+        {
+            if (!m_table)
+            {
+                return;
+            }
 
-            m_functions.erase(it, m_functions.end());
+            for (std::size_t i = 0; i < m_table->slots.size(); i++)
+            {
+                m_table->disconnect(static_cast<std::uint32_t>(i), m_table->slots[i].generation);
+            }
+        }
+
+        /**
+         * @brief Gets the amount of bound functions.
+         *
+         * @return The bound function count.
+         */
+        std::size_t size() const
+        {
+            return m_table ? m_table->connectedCount.load(std::memory_order_relaxed) : 0;
         }
 
         /**
@@ -67,21 +334,40 @@ namespace wpwp
          */
         static void combine(Signal<R...> &s1, const Signal<R...> &s2)
         {
-            for (auto &f : s2.getBindedFunctions())
+            if (!s2.m_table || &s1 == &s2)
             {
-                s1.bind(std::move(f));
+                return;
+            }
+
+            if (!s1.m_table)
+            {
+                s1.m_table = std::make_shared<SlotTable>();
+            }
+
+            for (const Slot &source : s2.m_table->slots)
+            {
+                if (source.connected)
+                {
+                    Slot &slot = s1.m_table->slots[s1.m_table->acquire()];
+                    slot.ops = source.ops;
+                    slot.ops->copy(source.storage, slot.storage);
+                    slot.connected = true;
+                    s1.m_table->connectedCount.fetch_add(1, std::memory_order_relaxed);
+                }
             }
         }
 
         /**
-         * @brief Overloaded += operator for binding a function or combining signals.
+         * @brief Overloaded += operator for binding a function.
          *
-         * @param f The function to bind or signal to combine.
+         * @param f The function to bind.
          * @return Reference to the modified Signal object.
          */
-        Signal &operator+=(std::function<void(R...)> &&f)
+        template <typename F>
+            requires std::is_invocable_v<std::decay_t<F> &, R &...>
+        Signal &operator+=(F &&f)
         {
-            bind(std::forward<std::function<void(R...)>>(f));
+            bind(std::forward<F>(f));
             return *this;
         }
 
@@ -102,27 +388,244 @@ namespace wpwp
         /**
          * @brief Overloaded -= operator for unbinding a function from the signal.
          *
-         * @param f The function to unbind.
+         * @param connection The handle returned when the function was bound.
          * @return Reference to the modified Signal object.
          */
-        Signal &operator-=(std::function<void(R...)> &&f)
+        Signal &operator-=(Connection connection)
         {
-            unbind(std::forward<std::function<void(R...)>>(f));
+            unbind(std::move(connection));
             return *this;
         }
 
+    private:
         /**
-         * @brief Get all of the binded functions of the signal.
-         *
-         * @return A vector containing all of the binded functions.
+         * @brief Lets go of the table, it's handed to itself instead while an invocation is still running on it.
          */
-        std::vector<std::function<void(R...)>> getBindedFunctions() const
+        void releaseTable()
         {
-            return m_functions;
+            if (m_table && m_table->dispatchDepth > 0)
+            {
+                m_table->keepAlive = std::move(m_table);
+            }
+            m_table.reset();
         }
 
-    private:
-        std::vector<std::function<void(R...)>> m_functions{}; // Vector to store connected functions.
+        /**
+         * @brief Operations on the function stored in a slot, one static table per function type.
+         */
+        struct Ops
+        {
+            void (*call)(void *storage, R &...args);
+            void (*copy)(const void *source, void *destination);
+            void (*destroy)(void *storage);
+        };
+
+        /**
+         * @brief Storage of one bound function.
+         */
+        struct Slot
+        {
+            alignas(std::max_align_t) std::byte storage[INLINE_SIZE]; // The function, or a pointer to it if it doesn't fit.
+            const Ops *ops = nullptr;                                  // Operations of the stored function, nullptr for free slots.
+            std::uint32_t generation = 0;                              // Bumped every time the slot is freed.
+            bool connected = false;                                    // Flag indicating whether the function is called.
+        };
+
+        /**
+         * @brief The slots, shared with the connections so they can tell when the signal is gone.
+         */
+        struct SlotTable : SlotTableBase
+        {
+            std::deque<Slot> slots;                                     // Never moves its elements, a slot stays put while its function runs.
+            std::vector<std::uint32_t> freeSlots;                       // Slots free for reuse.
+            std::vector<std::uint32_t> pendingFree;                     // Slots disconnected during an invocation, freed once it's over.
+            int dispatchDepth = 0;                                      // Amount of invocations in progress.
+            std::shared_ptr<SlotTable> keepAlive;                       // Set when the signal lets go of the table mid invocation.
+            std::atomic<std::size_t> connectedCount = 0;                // Bound functions, read by deferred invocations from any thread.
+            std::mutex deferredMutex;                                   // Guards deferredArgs, deferred invocations may come from worker threads.
+            std::optional<std::tuple<std::decay_t<R>...>> deferredArgs; // Arguments of the last deferred invocation, set while queued.
+
+            ~SlotTable() override
+            {
+                for (Slot &slot : slots)
+                {
+                    if (slot.ops)
+                    {
+                        slot.ops->destroy(slot.storage);
+                    }
+                }
+            }
+
+            void dispatch(R &...args)
+            {
+                dispatchDepth++;
+
+                // Counted upfront, functions bound from inside the loop wait for the next invocation
+                const std::size_t count = slots.size();
+                for (std::size_t i = 0; i < count; i++)
+                {
+                    Slot &slot = slots[i];
+                    if (slot.connected)
+                    {
+                        slot.ops->call(slot.storage, args...);
+                    }
+                }
+
+                if (--dispatchDepth == 0)
+                {
+                    if (!pendingFree.empty())
+                    {
+                        collect();
+                    }
+
+                    // The signal is gone, the table is destroyed here and nothing touches it after this
+                    if (keepAlive)
+                    {
+                        auto last = std::move(keepAlive);
+                    }
+                }
+            }
+
+            void defer(R &...args)
+            {
+                if (connectedCount.load(std::memory_order_relaxed) == 0)
+                {
+                    return;
+                }
+
+                // Only the first invocation since the last flush queues the signal, later ones replace the arguments
+                std::lock_guard<std::mutex> lock(deferredMutex);
+                const bool queued = deferredArgs.has_value();
+                deferredArgs.emplace(args...);
+                if (!queued)
+                {
+                    DeferredSignals::enqueue(weak_from_this());
+                }
+            }
+
+            void dispatchDeferred() override
+            {
+                std::unique_lock<std::mutex> lock(deferredMutex);
+                if (!deferredArgs)
+                {
+                    return;
+                }
+
+                // Cleared first, so functions invoking the signal again queue it for the next flush
+                std::tuple<std::decay_t<R>...> args = std::move(*deferredArgs);
+                deferredArgs.reset();
+                lock.unlock();
+                std::apply([this](auto &...values)
+                           { dispatch(values...); }, args);
+            }
+
+            std::uint32_t acquire()
+            {
+                // A freed slot isn't reused mid invocation, it could be called by it
+                if (dispatchDepth == 0 && !freeSlots.empty())
+                {
+                    std::uint32_t index = freeSlots.back();
+                    freeSlots.pop_back();
+                    return index;
+                }
+
+                slots.emplace_back();
+                return static_cast<std::uint32_t>(slots.size() - 1);
+            }
+
+            void disconnect(std::uint32_t index, std::uint32_t generation) override
+            {
+                if (!isConnected(index, generation))
+                {
+                    return;
+                }
+
+                slots[index].connected = false;
+                connectedCount.fetch_sub(1, std::memory_order_relaxed);
+                if (dispatchDepth > 0)
+                {
+                    // The function may be the one running, it's destroyed after the invocation
+                    pendingFree.push_back(index);
+                }
+                else
+                {
+                    release(index);
+                }
+            }
+
+            bool isConnected(std::uint32_t index, std::uint32_t generation) const override
+            {
+                return index < slots.size() && slots[index].generation == generation && slots[index].connected;
+            }
+
+            void release(std::uint32_t index)
+            {
+                Slot &slot = slots[index];
+                slot.ops->destroy(slot.storage);
+                slot.ops = nullptr;
+                slot.generation++;
+                freeSlots.push_back(index);
+            }
+
+            void collect()
+            {
+                for (std::uint32_t index : pendingFree)
+                {
+                    release(index);
+                }
+                pendingFree.clear();
+            }
+        };
+
+        template <typename F>
+        static constexpr bool fitsInline = sizeof(F) <= INLINE_SIZE && alignof(F) <= alignof(std::max_align_t);
+
+        template <typename F>
+        static F &access(void *storage)
+        {
+            if constexpr (fitsInline<F>)
+            {
+                return *std::launder(reinterpret_cast<F *>(storage));
+            }
+            else
+            {
+                return **std::launder(reinterpret_cast<F **>(storage));
+            }
+        }
+
+        template <typename F, typename Arg>
+        static void construct(void *storage, Arg &&f)
+        {
+            if constexpr (fitsInline<F>)
+            {
+                new (storage) F(std::forward<Arg>(f));
+            }
+            else
+            {
+                new (storage) F *(new F(std::forward<Arg>(f)));
+            }
+        }
+
+        template <typename F>
+        static constexpr Ops opsFor{
+            [](void *storage, R &...args)
+            { access<F>(storage)(args...); },
+            [](const void *source, void *destination)
+            { construct<F>(destination, access<F>(const_cast<void *>(source))); },
+            [](void *storage)
+            {
+                if constexpr (fitsInline<F>)
+                {
+                    access<F>(storage).~F();
+                }
+                else
+                {
+                    delete &access<F>(storage);
+                }
+            }};
+
+        std::shared_ptr<SlotTable> m_table; // Slots of the bound functions, created by the first bind.
+        bool m_deferred = false;            // Flag indicating whether invocations wait for DeferredSignals::flush().
     };
 } // namespace wpwp
 
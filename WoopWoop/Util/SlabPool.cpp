@@ -0,0 +1,68 @@
+#include "SlabPool.hpp"
+#include "Arena.hpp"
+#include <algorithm>
+
+namespace wpwp
+{
+    void SlabPool::reset()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_freeList = nullptr;
+        m_slabCursor = nullptr;
+        m_slabEnd = nullptr;
+    }
+
+    void *SlabPool::do_allocate(std::size_t bytes, std::size_t alignment)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_blockSize == 0)
+        {
+            // Rounded so every block of a slab keeps the alignment and can hold a free list node
+            std::size_t blockAlignment = std::max(alignment, alignof(FreeBlock));
+            m_blockSize = (std::max(bytes, sizeof(FreeBlock)) + blockAlignment - 1) / blockAlignment * blockAlignment;
+        }
+
+        if (bytes > m_blockSize || alignment > CACHE_LINE || m_blockSize % alignment != 0)
+        {
+            // Not what the pool was made for, served by the arena itself
+            lock.unlock();
+            return m_arena.allocate(bytes, alignment);
+        }
+
+        void *block;
+        if (m_freeList)
+        {
+            block = m_freeList;
+            m_freeList = m_freeList->next;
+        }
+        else
+        {
+            if (m_slabCursor == m_slabEnd)
+            {
+                std::size_t slabBytes = std::max(MIN_BLOCKS, SLAB_BYTES / m_blockSize) * m_blockSize;
+                m_slabCursor = static_cast<std::byte *>(m_arena.allocateSlab(slabBytes, CACHE_LINE));
+                m_slabEnd = m_slabCursor + slabBytes;
+            }
+
+            block = m_slabCursor;
+            m_slabCursor += m_blockSize;
+        }
+
+        m_arena.m_liveCount.fetch_add(1, std::memory_order_relaxed);
+        return block;
+    }
+
+    void SlabPool::do_deallocate(void *pointer, std::size_t bytes, std::size_t alignment)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (bytes > m_blockSize || alignment > CACHE_LINE || m_blockSize % alignment != 0)
+        {
+            lock.unlock();
+            m_arena.deallocate(pointer, bytes, alignment);
+            return;
+        }
+
+        m_freeList = new (pointer) FreeBlock{m_freeList};
+        m_arena.m_liveCount.fetch_sub(1, std::memory_order_relaxed);
+    }
+} // namespace wpwp
@@ -0,0 +1,66 @@
+#ifndef SLAB_POOL_HPP
+#define SLAB_POOL_HPP
+
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
+
+namespace wpwp
+{
+    class Arena;
+
+    /**
+     * @brief Free list allocator for blocks of a single size, carved out of cache line aligned slabs taken from an arena.
+     *
+     * Freed blocks are reused by the next allocation, so churn never reaches the heap and blocks of one pool stay close together.
+     * Blocks never move, the slabs are only handed back when the arena is released.
+     * A pool is owned by its arena and lives exactly as long, blocks still alive when the arena's owner lets go make Arena::dispose() leak both.
+     */
+    class SlabPool : public std::pmr::memory_resource
+    {
+    public:
+        static constexpr std::size_t CACHE_LINE = 64;        // Alignment of every slab.
+        static constexpr std::size_t SLAB_BYTES = 16 * 1024; // Target size of a slab.
+        static constexpr std::size_t MIN_BLOCKS = 16;        // Fewest blocks in a slab, for large blocks.
+
+        /**
+         * @brief Creates an empty pool, the block size is fixed by the first allocation.
+         *
+         * @param arena The arena the slabs are taken from and whose live count the blocks are tracked in.
+         */
+        explicit SlabPool(Arena &arena) : m_arena(arena) {}
+
+        SlabPool(const SlabPool &) = delete;
+        SlabPool &operator=(const SlabPool &) = delete;
+
+        /**
+         * @brief Forgets every slab, called by the arena when it hands them back.
+         */
+        void reset();
+
+        std::size_t getBlockSize() const { return m_blockSize; }
+
+    private:
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void *pointer, std::size_t bytes, std::size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+        /**
+         * @brief Node of the free list, stored inside the freed block itself.
+         */
+        struct FreeBlock
+        {
+            FreeBlock *next;
+        };
+
+    private:
+        Arena &m_arena;                    // Arena the slabs come from.
+        std::mutex m_mutex;                // Guards the free list and the current slab.
+        std::size_t m_blockSize = 0;       // Size of every block, 0 until the first allocation.
+        FreeBlock *m_freeList = nullptr;   // Freed blocks, reused first.
+        std::byte *m_slabCursor = nullptr; // Next never used block of the current slab.
+        std::byte *m_slabEnd = nullptr;    // End of the current slab.
+    };
+} // namespace wpwp
+
+#endif // SLAB_POOL_HPP
@@ -19,6 +19,13 @@ namespace wpwp
          */
         virtual void update() { return; };
 
+        /**
+         * @brief Advances the subsystem by one simulation step, called at the engine's tick rate after the components' fixedUpdate().
+         *
+         * @param deltaTime The length of a step, in seconds.
+         */
+        virtual void fixedUpdate(float) { return; };
+
         /**
          * @brief Cleans up the subsystem.
          */
@@ -0,0 +1,172 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+
+namespace wpwp
+{
+    namespace
+    {
+        // Which pool and queue the current thread works for, lets submit() keep follow-up tasks local
+        thread_local ThreadPool *t_pool = nullptr;
+        thread_local std::size_t t_queueIndex = 0;
+    }
+
+    ThreadPool::ThreadPool(std::size_t threadCount)
+    {
+        threadCount = std::max<std::size_t>(threadCount, 1);
+
+        for (std::size_t i = 0; i < threadCount; i++)
+        {
+            m_queues.push_back(std::make_unique<Queue>());
+        }
+
+        for (std::size_t i = 0; i < threadCount; i++)
+        {
+            m_threads.emplace_back([this, i]()
+                                   { workerLoop(i); });
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+
+        for (auto &thread : m_threads)
+        {
+            thread.join();
+        }
+    }
+
+    ThreadPool &ThreadPool::getInstance()
+    {
+        static ThreadPool instance(std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 1);
+        return instance;
+    }
+
+    void ThreadPool::submit(Task task)
+    {
+        {
+            // Counted before it is queued so the count never drops below zero, the lock orders it with a worker going to sleep
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            m_pending++;
+        }
+
+        std::size_t index = t_pool == this ? t_queueIndex : m_nextQueue++ % m_queues.size();
+        {
+            std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+            m_queues[index]->tasks.push_back(std::move(task));
+        }
+        m_wake.notify_one();
+    }
+
+    bool ThreadPool::runPendingTask()
+    {
+        Task task;
+        if (!takeTask(t_pool == this ? t_queueIndex : 0, task))
+        {
+            return false;
+        }
+
+        task();
+        return true;
+    }
+
+    void ThreadPool::parallelFor(std::size_t count, std::size_t grainSize, const std::function<void(std::size_t, std::size_t)> &body)
+    {
+        grainSize = std::max<std::size_t>(grainSize, 1);
+        if (count <= grainSize)
+        {
+            if (count > 0)
+            {
+                body(0, count);
+            }
+            return;
+        }
+
+        // Decremented under the lock, so the caller can't see zero and return while the last chunk still notifies
+        std::atomic<std::size_t> remaining{(count - 1) / grainSize};
+        std::mutex doneMutex;
+        std::condition_variable done;
+        for (std::size_t begin = grainSize; begin < count; begin += grainSize)
+        {
+            std::size_t end = std::min(begin + grainSize, count);
+            submit([&body, &remaining, &doneMutex, &done, begin, end]()
+                   {
+                body(begin, end);
+                std::lock_guard<std::mutex> lock(doneMutex);
+                if (--remaining == 0)
+                {
+                    done.notify_one();
+                } });
+        }
+
+        body(0, grainSize);
+
+        // Help while anything is queued, once the queues are empty every chunk is running somewhere
+        while (remaining > 0 && runPendingTask())
+        {
+        }
+
+        std::unique_lock<std::mutex> lock(doneMutex);
+        done.wait(lock, [&remaining]()
+                  { return remaining == 0; });
+    }
+
+    bool ThreadPool::takeTask(std::size_t preferred, Task &task)
+    {
+        {
+            Queue &own = *m_queues[preferred];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty())
+            {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                m_pending--;
+                return true;
+            }
+        }
+
+        for (std::size_t offset = 1; offset < m_queues.size(); offset++)
+        {
+            Queue &victim = *m_queues[(preferred + offset) % m_queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty())
+            {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                m_pending--;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void ThreadPool::workerLoop(std::size_t index)
+    {
+        t_pool = this;
+        t_queueIndex = index;
+
+        while (true)
+        {
+            Task task;
+            if (takeTask(index, task))
+            {
+                task();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            m_wake.wait(lock, [this]()
+                        { return m_stopping || m_pending > 0; });
+
+            if (m_stopping && m_pending == 0)
+            {
+                return;
+            }
+        }
+    }
+} // namespace wpwp
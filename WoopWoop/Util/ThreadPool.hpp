@@ -0,0 +1,108 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace wpwp
+{
+    /**
+     * @brief Fixed size pool of worker threads with one task queue per worker.
+     *
+     * Workers take tasks from the back of their own queue and steal from the front of the others when it runs dry,
+     * tasks submitted from a worker go to that worker's queue so follow-up work stays on the same core.
+     */
+    class ThreadPool
+    {
+    public:
+        using Task = std::function<void()>;
+
+        /**
+         * @brief Starts the worker threads.
+         *
+         * @param threadCount Amount of workers, at least one.
+         */
+        explicit ThreadPool(std::size_t threadCount);
+
+        /**
+         * @brief Finishes the queued tasks and joins the workers.
+         */
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        /**
+         * @brief Gets the shared pool, sized to leave one core to the main thread.
+         *
+         * @return Reference to the pool.
+         */
+        static ThreadPool &getInstance();
+
+        /**
+         * @brief Queues a task to run on one of the workers.
+         *
+         * @param task The task to run.
+         */
+        void submit(Task task);
+
+        /**
+         * @brief Runs one queued task on the calling thread, if there is any.
+         * Lets a thread that waits on the pool help instead of blocking.
+         *
+         * @return True if a task was run.
+         */
+        bool runPendingTask();
+
+        /**
+         * @brief Runs body over [0, count) split in chunks of grainSize, the calling thread runs a chunk and helps until all are done.
+         * Small ranges run inline without touching the queues, once nothing is left to help with the caller sleeps until the last chunk ends.
+         *
+         * @param count Size of the range.
+         * @param grainSize Size of each chunk, at least one.
+         * @param body Called with the begin and end of a chunk, from several threads at once.
+         */
+        void parallelFor(std::size_t count, std::size_t grainSize, const std::function<void(std::size_t, std::size_t)> &body);
+
+        /**
+         * @brief Gets the amount of worker threads.
+         *
+         * @return The worker count.
+         */
+        std::size_t getThreadCount() const { return m_threads.size(); }
+
+    private:
+        /**
+         * @brief Task queue owned by a worker.
+         */
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        void workerLoop(std::size_t index);
+
+        /**
+         * @brief Takes a task, from the back of the preferred queue first, then from the front of the others.
+         */
+        bool takeTask(std::size_t preferred, Task &task);
+
+    private:
+        std::vector<std::unique_ptr<Queue>> m_queues; // One queue per worker.
+        std::vector<std::thread> m_threads;           // The worker threads.
+        std::atomic<std::size_t> m_pending{0};        // Tasks queued but not taken yet.
+        std::atomic<std::size_t> m_nextQueue{0};      // Round robin target for tasks submitted from outside the pool.
+        std::atomic<bool> m_stopping{false};          // Set when the pool is shutting down.
+        std::mutex m_sleepMutex;                      // Guards sleeping on m_wake.
+        std::condition_variable m_wake;               // Wakes idle workers when tasks are queued.
+    };
+} // namespace wpwp
+
+#endif // THREAD_POOL_HPP
@@ -26,6 +26,7 @@ namespace wpwp
 
         /**
          * @brief Gets the delta time.
+         * The length of the frame, or of the simulation step while fixedUpdate() runs.
          *
          * @return A float representing the delta time.
          */
@@ -9,9 +9,16 @@
 #include "Scene.hpp"
 #include "Util/Util.hpp"
 #include "Util/Signal.hpp"
+#include "Util/QueuedSignal.hpp"
 
 #include "ECS/Entity.hpp"
+#include "ECS/Tags.hpp"
 #include "ECS/Component.hpp"
+#include "ECS/Query.hpp"
+#include "ECS/System.hpp"
+#include "ECS/CommandBuffer.hpp"
+#include "ECS/Prefab.hpp"
+#include "ECS/SpatialIndex.hpp"
 
 #include "ECS/Components/Transform.hpp"
 #include "ECS/Components/Camera2D.hpp"
@@ -5,7 +5,6 @@
 
 void wpwp::BallComponent::start()
 {
-    m_velocity = sf::Vector2f(1, 2);
     m_renderer = entity->getComponent<wpwp::CircleRenderer>();
 }
 
@@ -22,28 +21,19 @@ void wpwp::BallComponent::update()
     auto position = *transform->getPosition();
     if (position.y >= 1000 || position.y < 0)
     {
-        m_velocity.y *= -1;
+        velocity.y *= -1;
         changeColor();
     }
 
     if (position.x >= 1800 || position.x < 0)
     {
-        m_velocity.x *= -1;
+        velocity.x *= -1;
         changeColor();
     }
 
     float delta = wpwp::Util::deltaTime() * 1000;
-    position.y += m_velocity.y * delta;
-    position.x += m_velocity.x * delta;
+    position.y += velocity.y * delta;
+    position.x += velocity.x * delta;
 
     transform->setPosition(position);
 }
-
-void wpwp::BallComponent::onDrawGUI()
-{
-    float v[2] = {m_velocity.x, m_velocity.y};
-    if (ImGui::InputFloat2("Velocity", v))
-    {
-        m_velocity = sf::Vector2f(v[0], v[1]);
-    }
-}
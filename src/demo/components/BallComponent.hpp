@@ -9,17 +9,18 @@ namespace wpwp
         void start() override;
         void update() override;
         std::string getName() const override { return "BallComponent"; }
-        void onDrawGUI() override;
+
+        sf::Vector2f velocity{1, 2}; // Speed of the ball, in pixels per millisecond.
 
     private:
         void changeColor();
 
     private:
-        sf::Vector2f m_velocity;
-        std::shared_ptr<wpwp::CircleRenderer> m_renderer;
+        wpwp::CircleRenderer *m_renderer = nullptr;
     };
 
-    WREGISTER(BallComponent)
+    WREGISTER(BallComponent,
+              WFIELD("Velocity", velocity))
 
 } // namespace demo
 
@@ -16,7 +16,7 @@ namespace wpwp
         std::string getName() const override { return "Platformer"; }
 
     private:
-        std::shared_ptr<PhysicsBody2D> m_physicsBody;
+        PhysicsBody2D *m_physicsBody = nullptr;
     };
 
     WREGISTER(Platformer)
@@ -19,7 +19,7 @@ namespace wpwp
 
         // e1->transform->setScale(sf::Vector3f(100, 100, 0));
         // e1->addComponent<SpriteRenderer>();
-        // std::shared_ptr<SpriteRenderer> sp = e1->getComponent<SpriteRenderer>();
+        // SpriteRenderer *sp = e1->getComponent<SpriteRenderer>();
         // e1->addComponent<MouseController>();
         // sp->loadSprite("assets/test.png");
         // Entity::instantiate(e1);
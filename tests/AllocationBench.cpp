@@ -0,0 +1,86 @@
+#include "Bench.hpp"
+#include "WoopWoop.hpp"
+#include <array>
+#include <memory>
+#include <vector>
+
+using namespace wpwp;
+
+// Compares Arena::makeShared() against std::make_shared: churn of short lived objects, and a pass over objects created interleaved with others.
+
+namespace
+{
+    struct Body
+    {
+        float x = 0, y = 0, vx = 1, vy = 1;
+        virtual ~Body() = default;
+    };
+
+    // Stands for the other components created between two bodies
+    struct Other
+    {
+        std::array<char, 72> data{};
+        virtual ~Other() = default;
+    };
+
+    constexpr std::size_t OBJECT_COUNT = 10000;
+
+    template <typename Make>
+    double churn(const char *name, Make make)
+    {
+        std::vector<std::shared_ptr<Body>> bodies;
+        bodies.reserve(OBJECT_COUNT);
+        return bench::run(name, 200, [&]
+                          {
+            for (std::size_t i = 0; i < OBJECT_COUNT; i++)
+            {
+                bodies.push_back(make.template operator()<Body>());
+            }
+            bodies.clear(); });
+    }
+
+    template <typename Make>
+    double pass(const char *name, Make make)
+    {
+        std::vector<std::shared_ptr<Body>> bodies;
+        std::vector<std::shared_ptr<Other>> others;
+        for (std::size_t i = 0; i < OBJECT_COUNT; i++)
+        {
+            bodies.push_back(make.template operator()<Body>());
+            others.push_back(make.template operator()<Other>());
+            others.push_back(make.template operator()<Other>());
+        }
+
+        return bench::run(name, 2000, [&]
+                          {
+            for (auto &body : bodies)
+            {
+                body->x += body->vx;
+                body->y += body->vy;
+            }
+            bench::keep(bodies.front()->x); });
+    }
+}
+
+int main()
+{
+    auto heap = []<typename T>()
+    { return std::make_shared<T>(); };
+    auto arena = []<typename T>()
+    { return Arena::makeShared<T>(); };
+
+    Scene scene;
+    scene.activate();
+
+    std::printf("%zu objects per run\n", OBJECT_COUNT);
+    double heapChurn = churn("std::make_shared, create and free", heap);
+    double arenaChurn = churn("Arena::makeShared, create and free", arena);
+    std::printf("%-48s %12.1fx\n", "speedup", heapChurn / arenaChurn);
+
+    double heapPass = pass("std::make_shared, pass over interleaved", heap);
+    double arenaPass = pass("Arena::makeShared, pass over interleaved", arena);
+    std::printf("%-48s %12.1fx\n", "speedup", heapPass / arenaPass);
+
+    scene.unload();
+    return 0;
+}
@@ -0,0 +1,45 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+namespace bench
+{
+    /**
+     * @brief Keeps a value from being optimized away.
+     */
+    template <typename T>
+    inline void keep(const T &value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    /**
+     * @brief Runs a body once to warm up, then times it and prints the average.
+     *
+     * @param name Name printed in front of the result.
+     * @param iterations Amount of timed runs.
+     * @param body The measured work, called without arguments.
+     * @return The average time of a run, in nanoseconds.
+     */
+    template <typename F>
+    double run(const char *name, std::size_t iterations, F &&body)
+    {
+        body();
+
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < iterations; i++)
+        {
+            body();
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+        double average = elapsed.count() / static_cast<double>(iterations);
+        std::printf("%-48s %12.1f ns\n", name, average);
+        return average;
+    }
+} // namespace bench
+
+#endif // BENCH_HPP
@@ -0,0 +1,20 @@
+#ifndef CHECK_HPP
+#define CHECK_HPP
+
+#include <cstdio>
+#include <cstdlib>
+
+/**
+ * @brief Fails the test with the condition and its location if the condition is false, also in release builds.
+ */
+#define CHECK(condition)                                                                         \
+    do                                                                                           \
+    {                                                                                            \
+        if (!(condition))                                                                        \
+        {                                                                                        \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            std::exit(1);                                                                        \
+        }                                                                                        \
+    } while (false)
+
+#endif // CHECK_HPP
@@ -0,0 +1,115 @@
+#include "Bench.hpp"
+#include "WoopWoop.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace wpwp;
+
+// Compares Entity::getComponent<T>() against the linear dynamic_pointer_cast scan over a per-entity vector it replaced.
+
+namespace
+{
+    struct Health : Component
+    {
+        int value = 100;
+        std::string getName() const override { return "Health"; }
+    };
+
+    struct Velocity : Component
+    {
+        float x = 0, y = 0;
+        std::string getName() const override { return "Velocity"; }
+    };
+
+    struct Collider : Component
+    {
+        std::string getName() const override { return "Collider"; }
+    };
+
+    struct BoxCollider : Collider
+    {
+        float width = 1, height = 1;
+        std::string getName() const override { return "BoxCollider"; }
+    };
+
+    struct Armor : Component
+    {
+        int value = 5;
+        std::string getName() const override { return "Armor"; }
+    };
+
+    struct Missing : Component
+    {
+        std::string getName() const override { return "Missing"; }
+    };
+
+    constexpr std::size_t ENTITY_COUNT = 10000;
+    constexpr std::size_t ITERATIONS = 200;
+
+    // Baseline: the components of an entity in a vector, found by casting each in turn
+    template <typename T>
+    T *scan(const std::vector<std::shared_ptr<Component>> &components)
+    {
+        for (auto &component : components)
+        {
+            if (auto casted = std::dynamic_pointer_cast<T>(component))
+            {
+                return casted.get();
+            }
+        }
+        return nullptr;
+    }
+
+    template <typename T>
+    void compare(const char *typeName, const std::vector<std::shared_ptr<Entity>> &entities, const std::vector<std::vector<std::shared_ptr<Component>>> &vectors)
+    {
+        std::string name = std::string("getComponent<") + typeName + ">";
+        double ids = bench::run(name.c_str(), ITERATIONS, [&]
+                                {
+            for (auto &entity : entities)
+            {
+                bench::keep(entity->getComponent<T>());
+            } });
+
+        name = std::string("vector scan <") + typeName + ">";
+        double baseline = bench::run(name.c_str(), ITERATIONS, [&]
+                                     {
+            for (auto &components : vectors)
+            {
+                bench::keep(scan<T>(components));
+            } });
+
+        std::printf("%-48s %12.1fx\n", "speedup", baseline / ids);
+    }
+}
+
+int main()
+{
+    std::vector<std::shared_ptr<Entity>> entities;
+    std::vector<std::vector<std::shared_ptr<Component>>> vectors;
+    entities.reserve(ENTITY_COUNT);
+    vectors.reserve(ENTITY_COUNT);
+
+    for (std::size_t i = 0; i < ENTITY_COUNT; i++)
+    {
+        auto entity = Entity::createEntity(sf::Vector3f(0, 0, 0));
+        entity->addComponent<Health>();
+        entity->addComponent<Velocity>();
+        entity->addComponent<BoxCollider>();
+        entity->addComponent<Armor>();
+        entities.push_back(entity);
+
+        vectors.push_back({std::make_shared<Transform>(), std::make_shared<Health>(), std::make_shared<Velocity>(),
+                           std::make_shared<BoxCollider>(), std::make_shared<Armor>()});
+    }
+
+    std::printf("%zu entities with 5 components, time per pass over all of them\n", ENTITY_COUNT);
+    compare<Health>("Health", entities, vectors);
+    compare<Armor>("Armor", entities, vectors);
+    compare<Collider>("Collider (base)", entities, vectors);
+    compare<Missing>("Missing", entities, vectors);
+
+    Entity::destroyAll();
+    return 0;
+}
@@ -0,0 +1,165 @@
+#include "Check.hpp"
+#include "WoopWoop.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+using namespace wpwp;
+
+// Runs the frames of a headless engine over a static scene and checks that steady frames never allocate.
+// Engine::step() is the world work of Engine::run(): fixed steps, component updates, systems and the sync point.
+// Drawing needs a window and is left out.
+
+namespace
+{
+    std::atomic<bool> g_counting{false};
+    std::atomic<std::size_t> g_allocations{0};
+
+    void *allocate(std::size_t size, std::size_t alignment = 0)
+    {
+        if (g_counting.load(std::memory_order_relaxed))
+        {
+            g_allocations.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        size = size ? size : 1;
+        void *memory = alignment ? std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment) : std::malloc(size);
+        if (!memory)
+        {
+            throw std::bad_alloc();
+        }
+        return memory;
+    }
+
+    /**
+     * @brief Reads its neighbours every frame the way gameplay code does, without changing anything.
+     */
+    struct Watcher : Component
+    {
+        std::size_t seen = 0;
+
+        void update() override
+        {
+            if (entity->getComponent<Transform>() == transform)
+            {
+                seen++;
+            }
+            for (EntityId child : transform->getChildren())
+            {
+                if (Entity *e = Entity::get(child))
+                {
+                    seen += e->getComponents().size();
+                }
+            }
+        }
+
+        std::string getName() const override { return "Watcher"; }
+    };
+
+    struct Marker : Component
+    {
+        std::size_t steps = 0;
+
+        void fixedUpdate() override { steps++; }
+
+        std::string getName() const override { return "Marker"; }
+    };
+
+    /**
+     * @brief Reads the marked transforms every frame, run by the engine's system scheduler.
+     */
+    struct MarkerSystem : System
+    {
+        MarkerSystem() { reads<Transform, Marker>(); }
+
+        void update(float) override
+        {
+            markers.forEach([this](Entity &, Transform &transform, Marker &)
+                            { seen += transform.getChildren().size() + 1; });
+        }
+
+        Query<Transform, Marker> markers;
+        std::size_t seen = 0;
+    };
+
+    constexpr std::size_t PARENT_COUNT = 200;
+    constexpr std::size_t CHILDREN_PER_PARENT = 4;
+    constexpr int WARM_UP_FRAMES = 3;
+    constexpr int COUNTED_FRAMES = 10;
+
+    constexpr float FRAME_TIME = 1.0f / 60.0f; // One fixed step per frame at the default tick rate.
+
+    void runFrame(Engine &engine, std::vector<EntityId> &found)
+    {
+        engine.step(FRAME_TIME);
+
+        // Queries into caller owned storage, as gameplay and the editor do
+        found.clear();
+        SpatialIndex::getInstance().queryRegion(sf::FloatRect(-100, -100, 200, 200), found);
+    }
+}
+
+void *operator new(std::size_t size) { return allocate(size); }
+void *operator new[](std::size_t size) { return allocate(size); }
+void *operator new(std::size_t size, std::align_val_t alignment) { return allocate(size, static_cast<std::size_t>(alignment)); }
+void *operator new[](std::size_t size, std::align_val_t alignment) { return allocate(size, static_cast<std::size_t>(alignment)); }
+void operator delete(void *memory) noexcept { std::free(memory); }
+void operator delete[](void *memory) noexcept { std::free(memory); }
+void operator delete(void *memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void *memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void *memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void *memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete(void *memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void *memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+
+int main()
+{
+    Engine engine{Engine::Headless{}};
+    MarkerSystem system;
+    engine.addSystem(system);
+
+    Scene scene;
+    scene.activate();
+
+    Marker *firstMarker = nullptr;
+    for (std::size_t i = 0; i < PARENT_COUNT; i++)
+    {
+        auto parent = Entity::createEntity(sf::Vector3f(float(i % 20) * 10, float(i / 20) * 10, 0));
+        parent->addComponent<Watcher>();
+        Entity::instantiate(parent);
+
+        for (std::size_t c = 0; c < CHILDREN_PER_PARENT; c++)
+        {
+            auto child = Entity::createEntity(sf::Vector3f(float(c), 1, 0));
+            Marker *marker = child->addComponent<Marker>();
+            firstMarker = firstMarker ? firstMarker : marker;
+            child->transform->setParent(parent->getId());
+            Entity::instantiate(child);
+        }
+    }
+
+    std::vector<EntityId> found;
+
+    // Storage grows to its steady size during the first frames
+    for (int frame = 0; frame < WARM_UP_FRAMES; frame++)
+    {
+        runFrame(engine, found);
+    }
+
+    g_counting = true;
+    for (int frame = 0; frame < COUNTED_FRAMES; frame++)
+    {
+        runFrame(engine, found);
+    }
+    g_counting = false;
+
+    std::printf("%zu allocations over %d frames of %zu entities\n", g_allocations.load(), COUNTED_FRAMES, Entity::getAllEntities().size());
+    CHECK(!found.empty());
+    CHECK(system.seen > 0);
+    CHECK(firstMarker->steps == WARM_UP_FRAMES + COUNTED_FRAMES);
+    CHECK(g_allocations == 0);
+
+    scene.unload();
+    return 0;
+}
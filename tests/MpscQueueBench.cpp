@@ -0,0 +1,107 @@
+#include "Bench.hpp"
+#include "Util/MpscQueue.hpp"
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace wpwp;
+
+// Compares MpscQueue against a deque behind a mutex, with several producers pushing while one consumer pops.
+
+namespace
+{
+    constexpr std::size_t MESSAGES = 1000000; // Pushed in total per run, split between the producers.
+    constexpr std::size_t CAPACITY = 1024;
+
+    // Baseline: the usual locked queue, bounded the same way
+    template <typename T>
+    class LockedQueue
+    {
+    public:
+        bool tryPush(const T &value)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_values.size() == CAPACITY)
+            {
+                return false;
+            }
+            m_values.push_back(value);
+            return true;
+        }
+
+        bool tryPop(T &value)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_values.empty())
+            {
+                return false;
+            }
+            value = m_values.front();
+            m_values.pop_front();
+            return true;
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::deque<T> m_values;
+    };
+
+    template <typename Queue>
+    void pushAndPop(Queue &queue, std::size_t producerCount)
+    {
+        std::vector<std::thread> producers;
+        for (std::size_t p = 0; p < producerCount; p++)
+        {
+            producers.emplace_back([&queue, producerCount]
+                                   {
+                for (std::size_t i = 0; i < MESSAGES / producerCount; i++)
+                {
+                    while (!queue.tryPush(i))
+                    {
+                        std::this_thread::yield();
+                    }
+                } });
+        }
+
+        std::size_t value = 0;
+        std::size_t sum = 0;
+        for (std::size_t received = 0; received < MESSAGES / producerCount * producerCount;)
+        {
+            if (!queue.tryPop(value))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            sum += value;
+            received++;
+        }
+        bench::keep(sum);
+
+        for (auto &producer : producers)
+        {
+            producer.join();
+        }
+    }
+}
+
+int main()
+{
+    std::printf("%zu messages per run, time per run\n", MESSAGES);
+    for (std::size_t producers : {1, 2, 4, 8})
+    {
+        char name[64];
+        std::snprintf(name, sizeof(name), "MpscQueue, %zu producers", producers);
+        MpscQueue<std::size_t> lockFree(CAPACITY);
+        double ours = bench::run(name, 5, [&]
+                                 { pushAndPop(lockFree, producers); });
+
+        std::snprintf(name, sizeof(name), "mutex and deque, %zu producers", producers);
+        LockedQueue<std::size_t> locked;
+        double baseline = bench::run(name, 5, [&]
+                                     { pushAndPop(locked, producers); });
+
+        std::printf("%-48s %12.1fx\n", "speedup", baseline / ours);
+    }
+    return 0;
+}
@@ -0,0 +1,132 @@
+#include "Check.hpp"
+#include "Util/MpscQueue.hpp"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace wpwp;
+
+// Checks MpscQueue on its own, built with -fsanitize=thread by its own rule in the makefile.
+// Several producers push through a small ring that wraps around thousands of times while the consumer checks each producer's order.
+
+namespace
+{
+    constexpr std::size_t PRODUCER_COUNT = 4;
+    constexpr std::uint32_t PUSHES_PER_PRODUCER = 100000;
+    constexpr std::size_t CAPACITY = 64;
+
+    struct Message
+    {
+        std::uint32_t producer;
+        std::uint32_t sequence;
+    };
+
+    // Has no default constructor and can't be assigned, only tryPopWith() can take it out
+    struct Handle
+    {
+        explicit Handle(std::shared_ptr<int> value) : value(std::move(value)) {}
+        Handle(Handle &&) = default;
+        Handle &operator=(Handle &&) = delete;
+
+        std::shared_ptr<int> value;
+    };
+
+    void checkProducerOrder()
+    {
+        MpscQueue<Message> queue(CAPACITY);
+        std::atomic<std::size_t> fullPushes = 0;
+
+        std::vector<std::thread> producers;
+        for (std::uint32_t p = 0; p < PRODUCER_COUNT; p++)
+        {
+            producers.emplace_back([&queue, &fullPushes, p]
+                                   {
+                for (std::uint32_t i = 0; i < PUSHES_PER_PRODUCER; i++)
+                {
+                    while (!queue.tryPush(Message{p, i}))
+                    {
+                        fullPushes.fetch_add(1, std::memory_order_relaxed);
+                        std::this_thread::yield();
+                    }
+                } });
+        }
+
+        // Each producer's messages arrive in the order it pushed them, whatever the interleaving
+        std::vector<std::uint32_t> next(PRODUCER_COUNT, 0);
+        std::size_t received = 0;
+        Message message{};
+        while (received < PRODUCER_COUNT * PUSHES_PER_PRODUCER)
+        {
+            if (!queue.tryPop(message))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            CHECK(message.producer < PRODUCER_COUNT);
+            CHECK(message.sequence == next[message.producer]);
+            next[message.producer]++;
+            received++;
+        }
+
+        for (auto &producer : producers)
+        {
+            producer.join();
+        }
+
+        CHECK(!queue.tryPop(message));
+        std::printf("%zu messages through %zu cells, %zu pushes found the queue full\n", received, queue.getCapacity(), fullPushes.load());
+    }
+
+    void checkFullQueue()
+    {
+        MpscQueue<Message> queue(CAPACITY);
+        for (std::uint32_t i = 0; i < CAPACITY; i++)
+        {
+            CHECK(queue.tryPush(Message{0, i}));
+        }
+
+        Message rejected{1, 99};
+        CHECK(!queue.tryPush(rejected));
+
+        // Popping one frees exactly one cell, for the next lap
+        Message message{};
+        CHECK(queue.tryPop(message) && message.sequence == 0);
+        CHECK(queue.tryPush(Message{0, CAPACITY}));
+        CHECK(!queue.tryPush(rejected));
+
+        for (std::uint32_t i = 1; i <= CAPACITY; i++)
+        {
+            CHECK(queue.tryPop(message) && message.sequence == i);
+        }
+        CHECK(!queue.tryPop(message));
+    }
+
+    void checkValueLifetime()
+    {
+        auto value = std::make_shared<int>(7);
+        {
+            MpscQueue<Handle> queue(4);
+            CHECK(queue.tryPush(Handle(value)));
+            CHECK(queue.tryPush(Handle(value)));
+            CHECK(value.use_count() == 3);
+
+            int seen = 0;
+            CHECK(queue.tryPopWith([&seen](Handle &&handle)
+                                   { seen = *handle.value; }));
+            CHECK(seen == 7 && value.use_count() == 2);
+        }
+
+        // The queue destroys what's still in it
+        CHECK(value.use_count() == 1);
+    }
+}
+
+int main()
+{
+    checkFullQueue();
+    checkValueLifetime();
+    checkProducerOrder();
+    return 0;
+}
@@ -0,0 +1,112 @@
+#include "Bench.hpp"
+#include "Util/Signal.hpp"
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+
+using namespace wpwp;
+
+// Compares Signal against the vector of std::function it replaced, for invocations and for binding and unbinding.
+
+namespace
+{
+    constexpr std::size_t INVOCATIONS = 100000;
+    constexpr std::size_t BINDINGS = 10000;
+
+    // Baseline: functions in a vector, unbound by searching for them like the old signal did
+    struct FunctionList
+    {
+        std::vector<std::pair<std::size_t, std::function<void(int)>>> functions;
+        std::size_t nextId = 0;
+
+        std::size_t bind(std::function<void(int)> f)
+        {
+            functions.emplace_back(nextId, std::move(f));
+            return nextId++;
+        }
+
+        void unbind(std::size_t id)
+        {
+            functions.erase(std::find_if(functions.begin(), functions.end(), [id](auto &entry)
+                                         { return entry.first == id; }));
+        }
+
+        void invoke(int value)
+        {
+            for (auto &entry : functions)
+            {
+                entry.second(value);
+            }
+        }
+    };
+
+    void compareInvoke(std::size_t handlers)
+    {
+        long sum = 0;
+        Signal<int> signal;
+        FunctionList list;
+        for (std::size_t i = 0; i < handlers; i++)
+        {
+            signal += [&sum](int value)
+            { sum += value; };
+            list.bind([&sum](int value)
+                      { sum += value; });
+        }
+
+        char name[64];
+        std::snprintf(name, sizeof(name), "Signal::invoke, %zu functions", handlers);
+        double ours = bench::run(name, INVOCATIONS, [&]
+                                 { signal.invoke(1); });
+        std::snprintf(name, sizeof(name), "vector<std::function> invoke, %zu functions", handlers);
+        double baseline = bench::run(name, INVOCATIONS, [&]
+                                     { list.invoke(1); });
+        std::printf("%-48s %12.1fx\n", "speedup", baseline / ours);
+        bench::keep(sum);
+    }
+
+    void compareBinding()
+    {
+        long sum = 0;
+        Signal<int> signal;
+        std::vector<Connection> connections(BINDINGS);
+        double ours = bench::run("Signal bind then unbind, 10000 functions", 20, [&]
+                                 {
+            for (auto &connection : connections)
+            {
+                connection = signal.bind([&sum](int value)
+                                         { sum += value; });
+            }
+            for (auto &connection : connections)
+            {
+                connection.disconnect();
+            } });
+
+        FunctionList list;
+        std::vector<std::size_t> ids(BINDINGS);
+        double baseline = bench::run("vector<std::function> bind then unbind, 10000", 20, [&]
+                                     {
+            for (auto &id : ids)
+            {
+                id = list.bind([&sum](int value)
+                               { sum += value; });
+            }
+            for (auto &id : ids)
+            {
+                list.unbind(id);
+            } });
+
+        std::printf("%-48s %12.1fx\n", "speedup", baseline / ours);
+        bench::keep(sum);
+    }
+}
+
+int main()
+{
+    for (std::size_t handlers : {1, 8, 64})
+    {
+        compareInvoke(handlers);
+    }
+    compareBinding();
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include "Bench.hpp"
+#include "WoopWoop.hpp"
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace wpwp;
+
+// Times the spatial index at growing entity counts: building it, refreshing it as a few entities move, and each query.
+
+namespace
+{
+    constexpr float SPACING = 20.0f;         // Average distance between entities, in world units.
+    constexpr std::size_t QUERY_COUNT = 256; // Distinct query positions, cycled through.
+
+    void measure(std::size_t count)
+    {
+        std::mt19937 random(42);
+        const float side = std::sqrt(float(count)) * SPACING;
+        std::uniform_real_distribution<float> coordinate(0.0f, side);
+        std::uniform_real_distribution<float> size(2.0f, 16.0f);
+
+        std::vector<std::shared_ptr<Entity>> entities;
+        entities.reserve(count);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            auto entity = Entity::createEntity(sf::Vector3f(coordinate(random), coordinate(random), 0));
+            entity->transform->setScale(sf::Vector3f(size(random), size(random), 1));
+            entities.push_back(std::move(entity));
+        }
+        Entity::instantiate(entities);
+        Entity::flushLifecycleEvents();
+        Transform::propagateChanges();
+
+        SpatialIndex &index = SpatialIndex::getInstance();
+        std::printf("\n%zu entities over %.0f x %.0f, cells of %.0f\n", count, side, side, index.getCellSize());
+
+        auto start = std::chrono::steady_clock::now();
+        index.refresh();
+        std::chrono::duration<double, std::milli> built = std::chrono::steady_clock::now() - start;
+        std::printf("%-48s %12.1f ms\n", "first refresh, inserts everything", built.count());
+
+        bench::run("refresh, nothing moved", 100, [&]
+                   { index.refresh(); });
+
+        // A hundredth of the entities move every frame
+        std::size_t next = 0;
+        const std::size_t movers = count / 100;
+        bench::run("refresh, 1% moved", 20, [&]
+                   {
+            for (std::size_t i = 0; i < movers; i++)
+            {
+                Transform &transform = *entities[next++ % count]->transform;
+                transform.setPosition(sf::Vector3f(coordinate(random), coordinate(random), 0));
+            }
+            Transform::propagateChanges();
+            index.refresh(); });
+
+        std::vector<sf::Vector2f> points;
+        for (std::size_t i = 0; i < QUERY_COUNT; i++)
+        {
+            points.emplace_back(coordinate(random), coordinate(random));
+        }
+
+        std::vector<EntityId> found;
+        std::size_t query = 0;
+        bench::run("queryRegion 256 x 256", 10000, [&]
+                   {
+            sf::Vector2f point = points[query++ % QUERY_COUNT];
+            found.clear();
+            index.queryRegion(sf::FloatRect(point.x, point.y, 256, 256), found);
+            bench::keep(found.size()); });
+
+        bench::run("queryRadius 100", 10000, [&]
+                   {
+            found.clear();
+            index.queryRadius(points[query++ % QUERY_COUNT], 100, found);
+            bench::keep(found.size()); });
+
+        bench::run("queryNearest", 10000, [&]
+                   { bench::keep(index.queryNearest(points[query++ % QUERY_COUNT], side)); });
+
+        bench::run("queryRay 1000", 10000, [&]
+                   {
+            sf::Vector2f point = points[query % QUERY_COUNT];
+            float angle = float(query++) * 0.7f;
+            found.clear();
+            index.queryRay(point, sf::Vector2f(std::cos(angle), std::sin(angle)), 1000, found);
+            bench::keep(found.size()); });
+
+        entities.clear();
+        Entity::destroyAll();
+    }
+}
+
+int main()
+{
+    SpatialIndex::getInstance().setCellSize(64.0f);
+    for (std::size_t count : {10000, 100000, 1000000})
+    {
+        measure(count);
+    }
+    return 0;
+}